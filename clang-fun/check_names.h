@@ -1,8 +1,10 @@
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <utility>
 
 enum class Entity { kVariable, kField, kType, kConst, kFunction };
 
@@ -28,8 +30,138 @@ struct Mistake {
 struct Statistics {
     std::vector<BadName> bad_names;
     std::vector<Mistake> mistakes;
+    // Set if the file was skipped or only partially checked because of
+    // -fail-fast or -deadline.
+    bool incomplete = false;
 
     bool operator==(const Statistics&) const = default;
 };
 
+struct SourceBuffer {
+    std::string path;
+    std::string contents;
+};
+
 std::unordered_map<std::string, Statistics> CheckNames(int argc, const char* argv[]);
+
+// Checks unsaved buffers as main files. The buffers are never written to disk,
+// everything they include is still read from the real file system.
+std::unordered_map<std::string, Statistics> CheckBuffers(const std::vector<SourceBuffer>& buffers,
+                                                         const std::vector<std::string>& flags,
+                                                         const std::string& dict_path = {});
+
+// Keeps parsed translation units between checks of the same files. The include
+// preamble of a file is precompiled on the first check and reused afterwards,
+// so re-checking only parses the main file body again. The preamble is rebuilt
+// automatically when one of the included files changes. Not thread-safe.
+class CheckSession {
+public:
+    explicit CheckSession(const std::vector<std::string>& flags, const std::string& dict_path = {});
+    ~CheckSession();
+
+    Statistics Check(const SourceBuffer& buffer);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+// Baselines of known violations. Entries are matched by file, entity (or wrong
+// word), name and occurrence number rather than by line, so they survive edits.
+void WriteBaseline(const std::unordered_map<std::string, Statistics>& stats,
+                   const std::string& path);
+void SuppressBaseline(std::unordered_map<std::string, Statistics>* stats,
+                      const std::string& path);
+
+// Results in a compact binary form: fixed-width records plus a string table,
+// read directly from a memory mapping. Files are stored sorted by name, and
+// the order of records within a file is kept.
+void WriteStatistics(const std::unordered_map<std::string, Statistics>& stats,
+                     const std::string& path);
+bool ReadStatistics(const std::string& path,
+                    std::unordered_map<std::string, Statistics>* stats);
+
+// Combines results files, such as the per-translation-unit sidecars written by
+// the compiler plugin, into one map. Files are read in sorted path order.
+// Results for the same file name, e.g. of a file compiled once with and once
+// without -fPIC, are combined: a finding is kept once, at its first position.
+bool MergeStatistics(const std::vector<std::string>& paths,
+                     std::unordered_map<std::string, Statistics>* stats);
+
+// Aggregated results of a -summary run. Only fixed-size counters are kept
+// while checking, so memory use does not grow with the number of violations.
+struct SummaryCount {
+    std::string directory;
+    Entity entity;
+    std::string rule;  // Broken rule, named as in naming configs ("private-field", ...)
+    size_t count;
+
+    bool operator==(const SummaryCount&) const = default;
+};
+
+// One of the most frequent offending names, estimated with the Space-Saving
+// algorithm: it was reported at most count and at least count - error times.
+struct TopName {
+    std::string name;
+    size_t count;
+    size_t error;
+
+    bool operator==(const TopName&) const = default;
+};
+
+struct NameSummary {
+    std::vector<SummaryCount> bad_names;                // Sorted by directory, entity and rule
+    std::vector<std::pair<std::string, size_t>> typos;  // Misspelled words by directory
+    std::vector<TopName> top_names;                     // Bad or misspelled names, most frequent first
+    bool incomplete = false;                            // As in Statistics, for any file
+
+    bool operator==(const NameSummary&) const = default;
+};
+
+// Takes the arguments of CheckNames and checks in -summary mode.
+NameSummary SummarizeNames(int argc, const char* argv[]);
+
+// Violations per translation unit estimated by a -sample run, with the bounds
+// of a 95% confidence interval. high is infinite if the sample is too small
+// to tell.
+struct ViolationRate {
+    double rate = 0;
+    double low = 0;
+    double high = 0;
+
+    bool operator==(const ViolationRate&) const = default;
+};
+
+struct DirectoryEstimate {
+    std::string directory;
+    size_t files = 0;          // Translation units in the directory
+    size_t checked = 0;        // Of them sampled and fully checked
+    ViolationRate violations;  // Bad names and typos
+
+    bool operator==(const DirectoryEstimate&) const = default;
+};
+
+struct EntityEstimate {
+    Entity entity;
+    ViolationRate bad_names;
+
+    bool operator==(const EntityEstimate&) const = default;
+};
+
+// Rates are taken over the results of whole translation units as in
+// Statistics, so violations in a header count once for every file including it.
+struct NameEstimate {
+    std::vector<DirectoryEstimate> directories;  // Sorted by directory
+    std::vector<EntityEstimate> entities;        // Bad names by entity, for all directories
+    ViolationRate typos;                         // For all directories
+    ViolationRate violations;                    // Bad names and typos, for all directories
+    size_t files = 0;
+    size_t checked = 0;
+    bool incomplete = false;  // Some sampled file was not fully checked
+
+    bool operator==(const NameEstimate&) const = default;
+};
+
+// Takes the arguments of CheckNames, checks a stratified sample of the files
+// (all of them without -sample) and estimates violation rates from it.
+NameEstimate EstimateNames(int argc, const char* argv[]);
@@ -0,0 +1,163 @@
+#include "baseline.h"
+#include "output_file.h"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/xxhash.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+// Baseline file layout (native byte order):
+//   char     Magic[4]    "CNBL"
+//   uint32_t Version
+//   uint64_t Count
+//   uint64_t Fingerprints[Count]   sorted, unique
+//
+// A fingerprint hashes the file, the entity (or the wrong word for a typo), the
+// name and the occurrence number of that triple in the translation unit. Lines
+// are deliberately left out so that unrelated edits do not invalidate entries.
+
+static constexpr char BaselineMagic[4] = {'C', 'N', 'B', 'L'};
+static constexpr uint32_t BaselineVersion = 1;
+
+struct BaselineHeader {
+    char Magic[4];
+    uint32_t Version;
+    uint64_t Count;
+};
+
+namespace {
+
+// Numbers repeated occurrences of the same key within one translation unit.
+class OccurrenceCounter {
+public:
+    uint64_t fingerprint(char Kind, StringRef File, StringRef Name, StringRef Detail) {
+        Key.clear();
+        Key.push_back(Kind);
+        Key.append(File.begin(), File.end());
+        Key.push_back('\0');
+        Key.append(Name.begin(), Name.end());
+        Key.push_back('\0');
+        Key.append(Detail.begin(), Detail.end());
+        Key.push_back('\0');
+        uint64_t Occurrence = Seen[Key]++;
+        Key.append(std::to_string(Occurrence));
+        return xxHash64(Key);
+    }
+
+private:
+    StringMap<uint64_t> Seen;
+    std::string Key;
+};
+
+uint64_t badNameFingerprint(OccurrenceCounter &Counter, const BadName &Bad) {
+    return Counter.fingerprint('B', Bad.file, Bad.name,
+                               std::to_string(static_cast<int>(Bad.entity)));
+}
+
+uint64_t mistakeFingerprint(OccurrenceCounter &Counter, const Mistake &M) {
+    return Counter.fingerprint('M', M.file, M.name, M.wrong_word);
+}
+
+// Drops every item whose fingerprint is in the baseline, keeping the order.
+// Fingerprints must be computed in order because they number occurrences.
+template <class T, class FingerprintFn>
+void eraseKnown(std::vector<T> &Items, const Baseline &Known, FingerprintFn Fingerprint) {
+    size_t Out = 0;
+    for (size_t In = 0; In < Items.size(); ++In) {
+        if (Known.contains(Fingerprint(Items[In])))
+            continue;
+        if (In != Out)
+            Items[Out] = std::move(Items[In]);
+        ++Out;
+    }
+    Items.resize(Out);
+}
+
+} // namespace
+
+bool Baseline::load(const std::string &Path) {
+    auto BufferOrErr = MemoryBuffer::getFile(Path, /*IsText=*/false,
+                                             /*RequiresNullTerminator=*/false);
+    if (!BufferOrErr) {
+        errs() << "check_names: cannot read baseline " << Path << ": "
+               << BufferOrErr.getError().message() << "\n";
+        return false;
+    }
+    Buffer = std::move(*BufferOrErr);
+
+    BaselineHeader Header;
+    if (Buffer->getBufferSize() < sizeof(Header)) {
+        errs() << "check_names: truncated baseline " << Path << "\n";
+        return false;
+    }
+    std::memcpy(&Header, Buffer->getBufferStart(), sizeof(Header));
+    if (std::memcmp(Header.Magic, BaselineMagic, sizeof(BaselineMagic)) != 0 ||
+        Header.Version != BaselineVersion ||
+        Buffer->getBufferSize() != sizeof(Header) + Header.Count * sizeof(uint64_t)) {
+        errs() << "check_names: invalid baseline " << Path << "\n";
+        return false;
+    }
+    Begin = reinterpret_cast<const uint64_t *>(Buffer->getBufferStart() + sizeof(Header));
+    End = Begin + Header.Count;
+    return true;
+}
+
+bool Baseline::contains(uint64_t Fingerprint) const {
+    return std::binary_search(Begin, End, Fingerprint);
+}
+
+void Baseline::suppress(std::unordered_map<std::string, Statistics> *Stats) const {
+    for (auto &[File, FileStats] : *Stats) {
+        OccurrenceCounter Counter;
+        eraseKnown(FileStats.bad_names, *this, [&Counter](const BadName &Bad) {
+            return badNameFingerprint(Counter, Bad);
+        });
+        eraseKnown(FileStats.mistakes, *this, [&Counter](const Mistake &M) {
+            return mistakeFingerprint(Counter, M);
+        });
+    }
+}
+
+void WriteBaseline(const std::unordered_map<std::string, Statistics>& stats,
+                   const std::string& path) {
+    std::vector<uint64_t> Fingerprints;
+    for (const auto &[File, Stats] : stats) {
+        OccurrenceCounter Counter;
+        for (const auto &Bad : Stats.bad_names)
+            Fingerprints.push_back(badNameFingerprint(Counter, Bad));
+        for (const auto &M : Stats.mistakes)
+            Fingerprints.push_back(mistakeFingerprint(Counter, M));
+    }
+    std::sort(Fingerprints.begin(), Fingerprints.end());
+    Fingerprints.erase(std::unique(Fingerprints.begin(), Fingerprints.end()), Fingerprints.end());
+
+    std::error_code EC;
+    raw_fd_ostream Out(path, EC);
+    if (EC) {
+        errs() << "check_names: cannot write baseline " << path << ": " << EC.message() << "\n";
+        return;
+    }
+    BaselineHeader Header;
+    std::memcpy(Header.Magic, BaselineMagic, sizeof(BaselineMagic));
+    Header.Version = BaselineVersion;
+    Header.Count = Fingerprints.size();
+    Out.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+    Out.write(reinterpret_cast<const char *>(Fingerprints.data()),
+              Fingerprints.size() * sizeof(uint64_t));
+    // A truncated baseline would suppress only some of the known violations
+    closeOutput(Out, path, "baseline");
+}
+
+void SuppressBaseline(std::unordered_map<std::string, Statistics>* stats,
+                      const std::string& path) {
+    Baseline Known;
+    if (Known.load(path))
+        Known.suppress(stats);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "../check_names.h"
+#include <llvm/Support/MemoryBuffer.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Read-only view of a baseline file. The file is memory-mapped by
+// MemoryBuffer when it is large enough, and lookups are binary searches
+// directly over the mapped fingerprints. Safe to share between workers
+// once loaded.
+class Baseline {
+public:
+    bool load(const std::string &Path);
+
+    bool contains(uint64_t Fingerprint) const;
+
+    // Drops the known violations, keeping the order of the others.
+    void suppress(std::unordered_map<std::string, Statistics> *Stats) const;
+
+private:
+    std::unique_ptr<llvm::MemoryBuffer> Buffer;
+    const uint64_t *Begin = nullptr;
+    const uint64_t *End = nullptr;
+};
@@ -0,0 +1,239 @@
+#include "caching_fs.h"
+#include <llvm/ADT/Hashing.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <algorithm>
+
+using namespace llvm;
+
+namespace {
+
+// Absolute path without "." components. ".." is kept, since it cannot be
+// removed without resolving symbolic links.
+SmallString<256> normalizedPath(const Twine &Path, StringRef WorkingDir) {
+    SmallString<256> Result;
+    Path.toVector(Result);
+    if (!sys::path::is_absolute(Result))
+        sys::fs::make_absolute(WorkingDir, Result);
+    sys::path::remove_dots(Result);
+    return Result;
+}
+
+class CachedFile : public vfs::File {
+public:
+    CachedFile(FileSystemCache &Cache, SmallString<256> Key, vfs::Status Stat)
+        : Cache(Cache), Key(std::move(Key)), Stat(std::move(Stat)) {}
+
+    ErrorOr<vfs::Status> status() override { return Stat; }
+
+    ErrorOr<std::unique_ptr<MemoryBuffer>> getBuffer(const Twine &Name, int64_t FileSize,
+                                                     bool RequiresNullTerminator,
+                                                     bool IsVolatile) override {
+        auto Contents = Cache.contents(Key);
+        if (!Contents)
+            return Contents.getError();
+        // Cached buffers are always null-terminated
+        return MemoryBuffer::getMemBuffer((*Contents)->getBuffer(), Name.str(),
+                                          RequiresNullTerminator);
+    }
+
+    std::error_code close() override { return {}; }
+
+private:
+    FileSystemCache &Cache;
+    SmallString<256> Key;
+    vfs::Status Stat;
+};
+
+// Walks a cached listing, naming the entries after the directory as given.
+class CachedDirIterator : public vfs::detail::DirIterImpl {
+public:
+    CachedDirIterator(FileSystemCache::DirEntries Entries, std::string Dir)
+        : Entries(std::move(Entries)), Dir(std::move(Dir)) {
+        increment();
+    }
+
+    std::error_code increment() override {
+        if (Next == Entries->size()) {
+            CurrentEntry = vfs::directory_entry();
+            return {};
+        }
+        const auto &Entry = (*Entries)[Next++];
+        SmallString<256> Path(Dir);
+        sys::path::append(Path, sys::path::filename(Entry.path()));
+        CurrentEntry = vfs::directory_entry(std::string(Path), Entry.type());
+        return {};
+    }
+
+private:
+    FileSystemCache::DirEntries Entries;
+    std::string Dir;
+    size_t Next = 0;
+};
+
+} // namespace
+
+FileSystemCache::FileSystemCache() : Disk(vfs::createPhysicalFileSystem().release()) {}
+
+FileSystemCache::Shard &FileSystemCache::shardFor(StringRef Path) {
+    return Shards[hash_value(Path) % kNumShards];
+}
+
+ErrorOr<vfs::Status> FileSystemCache::status(StringRef Path) {
+    Shard &S = shardFor(Path);
+    {
+        std::lock_guard<std::mutex> Lock(S.Mutex);
+        auto It = S.Entries.find(Path);
+        if (It != S.Entries.end() && It->second.Stat)
+            return *It->second.Stat;
+    }
+    // Missing files are cached too: most lookups along include paths fail
+    auto Stat = Disk->status(Path);
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto &Cached = S.Entries[Path].Stat;
+    if (!Cached)
+        Cached = std::move(Stat);
+    return *Cached;
+}
+
+ErrorOr<const MemoryBuffer *> FileSystemCache::contents(StringRef Path) {
+    Shard &S = shardFor(Path);
+    {
+        std::lock_guard<std::mutex> Lock(S.Mutex);
+        auto It = S.Entries.find(Path);
+        if (It != S.Entries.end() && It->second.Contents)
+            return It->second.Contents.get();
+    }
+    // Read outside of the lock; if two workers race, the first buffer is kept
+    auto Buffer = Disk->getBufferForFile(Path, /*FileSize=*/-1,
+                                         /*RequiresNullTerminator=*/true, /*IsVolatile=*/false);
+    if (!Buffer)
+        return Buffer.getError();
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto &Cached = S.Entries[Path].Contents;
+    if (!Cached)
+        Cached = std::move(*Buffer);
+    return Cached.get();
+}
+
+ErrorOr<FileSystemCache::DirEntries> FileSystemCache::listDirectory(StringRef Path) {
+    Shard &S = shardFor(Path);
+    {
+        std::lock_guard<std::mutex> Lock(S.Mutex);
+        auto It = S.Entries.find(Path);
+        if (It != S.Entries.end() && It->second.Listing)
+            return It->second.Listing;
+    }
+    auto Listing = std::make_shared<std::vector<vfs::directory_entry>>();
+    std::error_code EC;
+    for (vfs::directory_iterator It = Disk->dir_begin(Path, EC), End; !EC && It != End;
+         It.increment(EC))
+        Listing->push_back(*It);
+    if (EC)
+        return EC;
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    auto &Cached = S.Entries[Path].Listing;
+    if (!Cached)
+        Cached = std::move(Listing);
+    return Cached;
+}
+
+CachingFileSystem::CachingFileSystem(FileSystemCache &Cache) : Cache(Cache) {
+    sys::fs::current_path(WorkingDir);
+}
+
+SmallString<256> CachingFileSystem::cacheKey(const Twine &Path) const {
+    return normalizedPath(Path, WorkingDir);
+}
+
+ErrorOr<vfs::Status> CachingFileSystem::status(const Twine &Path) {
+    auto Stat = Cache.status(cacheKey(Path));
+    if (!Stat)
+        return Stat.getError();
+    return vfs::Status::copyWithNewName(*Stat, Path);
+}
+
+ErrorOr<std::unique_ptr<vfs::File>> CachingFileSystem::openFileForRead(const Twine &Path) {
+    SmallString<256> Key = cacheKey(Path);
+    auto Stat = Cache.status(Key);
+    if (!Stat)
+        return Stat.getError();
+    if (Stat->isDirectory())
+        return std::make_error_code(std::errc::is_a_directory);
+    return std::make_unique<CachedFile>(Cache, std::move(Key),
+                                        vfs::Status::copyWithNewName(*Stat, Path));
+}
+
+vfs::directory_iterator CachingFileSystem::dir_begin(const Twine &Dir, std::error_code &EC) {
+    auto Listing = Cache.listDirectory(cacheKey(Dir));
+    if (!Listing) {
+        EC = Listing.getError();
+        return {};
+    }
+    EC = {};
+    return vfs::directory_iterator(std::make_shared<CachedDirIterator>(*Listing, Dir.str()));
+}
+
+std::error_code CachingFileSystem::setCurrentWorkingDirectory(const Twine &Path) {
+    SmallString<256> Key = cacheKey(Path);
+    auto Stat = Cache.status(Key);
+    if (!Stat)
+        return Stat.getError();
+    if (!Stat->isDirectory())
+        return std::make_error_code(std::errc::not_a_directory);
+    WorkingDir = std::move(Key);
+    return {};
+}
+
+ErrorOr<std::string> CachingFileSystem::getCurrentWorkingDirectory() const {
+    return std::string(WorkingDir);
+}
+
+std::error_code CachingFileSystem::getRealPath(const Twine &Path,
+                                               SmallVectorImpl<char> &Output) const {
+    return Cache.disk().getRealPath(cacheKey(Path), Output);
+}
+
+std::error_code CachingFileSystem::isLocal(const Twine &Path, bool &Result) {
+    return Cache.disk().isLocal(cacheKey(Path), Result);
+}
+
+ReadAhead::ReadAhead(FileSystemCache &Cache, std::vector<std::string> Files, size_t Window)
+    : Cache(Cache), Window(Window), Limit(Window) {
+    SmallString<256> WorkingDir;
+    sys::fs::current_path(WorkingDir);
+    for (const auto &File : Files)
+        Paths.push_back(std::string(normalizedPath(File, WorkingDir)));
+    Thread = std::thread([this] { run(); });
+}
+
+ReadAhead::~ReadAhead() {
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Stopping = true;
+    }
+    Wakeup.notify_one();
+    Thread.join();
+}
+
+void ReadAhead::started(size_t Index) {
+    {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Limit = std::max(Limit, Index + 1 + Window);
+    }
+    Wakeup.notify_one();
+}
+
+void ReadAhead::run() {
+    for (size_t i = 0; i < Paths.size(); ++i) {
+        {
+            std::unique_lock<std::mutex> Lock(Mutex);
+            Wakeup.wait(Lock, [&] { return Stopping || i < Limit; });
+            if (Stopping)
+                return;
+        }
+        // Errors are left for the worker, which reports them in context
+        Cache.status(Paths[i]);
+        Cache.contents(Paths[i]);
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <array>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Disk contents seen by all translation units of a run. Stats (including
+// missing files), directory listings and file contents are read at most once
+// and kept until the end of the run; large files are memory mapped by
+// MemoryBuffer. Keys are absolute paths. Safe to use from several workers.
+class FileSystemCache {
+public:
+    FileSystemCache();
+
+    llvm::ErrorOr<llvm::vfs::Status> status(llvm::StringRef Path);
+
+    // The buffer stays valid as long as the cache. Failed reads are retried.
+    llvm::ErrorOr<const llvm::MemoryBuffer *> contents(llvm::StringRef Path);
+
+    using DirEntries = std::shared_ptr<const std::vector<llvm::vfs::directory_entry>>;
+    llvm::ErrorOr<DirEntries> listDirectory(llvm::StringRef Path);
+
+    llvm::vfs::FileSystem &disk() { return *Disk; }
+
+private:
+    struct Entry {
+        std::optional<llvm::ErrorOr<llvm::vfs::Status>> Stat;
+        std::unique_ptr<llvm::MemoryBuffer> Contents;
+        DirEntries Listing;
+    };
+
+    // Entries are spread over shards by path, so that workers that look up
+    // different files rarely wait for each other.
+    struct Shard {
+        std::mutex Mutex;
+        llvm::StringMap<Entry> Entries;
+    };
+    static constexpr size_t kNumShards = 16;
+
+    Shard &shardFor(llvm::StringRef Path);
+
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> Disk;
+    std::array<Shard, kNumShards> Shards;
+};
+
+// File system of one tool on top of a shared cache. Only the working
+// directory is per tool, so tools of different workers do not change each
+// other's (or the process') working directory.
+class CachingFileSystem : public llvm::vfs::FileSystem {
+public:
+    explicit CachingFileSystem(FileSystemCache &Cache);
+
+    llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine &Path) override;
+    llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(
+        const llvm::Twine &Path) override;
+    llvm::vfs::directory_iterator dir_begin(const llvm::Twine &Dir,
+                                            std::error_code &EC) override;
+    std::error_code setCurrentWorkingDirectory(const llvm::Twine &Path) override;
+    llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override;
+    std::error_code getRealPath(const llvm::Twine &Path,
+                                llvm::SmallVectorImpl<char> &Output) const override;
+    std::error_code isLocal(const llvm::Twine &Path, bool &Result) override;
+
+private:
+    // Absolute path without "." components, the key in the cache
+    llvm::SmallString<256> cacheKey(const llvm::Twine &Path) const;
+
+    FileSystemCache &Cache;
+    llvm::SmallString<256> WorkingDir;
+};
+
+// Reads files into the cache on a thread of its own, in the order they will
+// be needed and at most Window files ahead of the last one started, so that
+// workers find the main files of their next translation units in memory.
+class ReadAhead {
+public:
+    ReadAhead(FileSystemCache &Cache, std::vector<std::string> Files, size_t Window);
+    ~ReadAhead();
+
+    // The file at Index is now being used.
+    void started(size_t Index);
+
+private:
+    void run();
+
+    FileSystemCache &Cache;
+    std::vector<std::string> Paths;
+    size_t Window;
+    std::mutex Mutex;
+    std::condition_variable Wakeup;
+    size_t Limit;  // Files before this index may be read
+    bool Stopping = false;
+    std::thread Thread;
+};
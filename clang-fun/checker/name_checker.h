@@ -0,0 +1,157 @@
+#pragma once
+
+#include "../check_names.h"
+#include "naming_policy.h"
+#include <clang/AST/ASTConsumer.h>
+#include <clang/AST/ASTContext.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Checking core shared by the command line driver (run_checks.cpp), the
+// library entry points and the compiler plugin.
+
+class Dictionary;
+class RenameFixes;
+class SummaryCounters;
+
+// Lines of each file that the preprocessor skipped, such as inactive #if
+// branches, by path of the file, so that headers with the same name in
+// different directories are told apart. Files it never entered, such as
+// headers that only an inactive branch includes, are skipped as a whole.
+class SkippedLines {
+public:
+    void enter(llvm::StringRef File) { Ranges.try_emplace(File); }
+
+    void add(llvm::StringRef File, unsigned First, unsigned Last) {
+        Ranges[File].emplace_back(First, Last);
+    }
+
+    bool contains(llvm::StringRef File, unsigned Line) const {
+        auto It = Ranges.find(File);
+        if (It == Ranges.end())
+            return true;
+        return std::any_of(It->second.begin(), It->second.end(), [&](const auto &Range) {
+            return Range.first <= Line && Line <= Range.second;
+        });
+    }
+
+    void clear() { Ranges.clear(); }
+
+private:
+    llvm::StringMap<std::vector<std::pair<unsigned, unsigned>>> Ranges;
+};
+
+// Dictionaries are loaded once per path and shared by every run in the process,
+// so that repeated checks of small buffers do not re-read the dictionary file.
+const Dictionary &loadDictionary(const std::string &Path);
+
+// Cooperative stop signal shared by all workers of a run: either a finding was
+// reported in fail-fast mode or the deadline has passed.
+class RunControl {
+public:
+    RunControl() = default;
+
+    // Control of a parse whose findings may still be thrown away, such as a
+    // jumbo batch that turns out not to compile: it stops when Parent does,
+    // but its findings only stop Parent once they are committed.
+    explicit RunControl(RunControl &Parent)
+        : Parent(&Parent), StopOnFirstFinding(Parent.StopOnFirstFinding) {}
+
+    void setDeadline(std::chrono::milliseconds Budget) {
+        Deadline = std::chrono::steady_clock::now() + Budget;
+        HasDeadline = true;
+    }
+
+    void setStopOnFirstFinding(bool Value) { StopOnFirstFinding = Value; }
+
+    void stop() { Stopped.store(true, std::memory_order_relaxed); }
+
+    bool stopRequested() const {
+        return Stopped.load(std::memory_order_relaxed) || (Parent && Parent->stopRequested());
+    }
+
+    void reportFinding() {
+        Found.store(true, std::memory_order_relaxed);
+        if (StopOnFirstFinding)
+            stop();
+    }
+
+    // Passes the findings reported so far on to Parent.
+    void commit() {
+        if (Parent && Found.load(std::memory_order_relaxed))
+            Parent->reportFinding();
+    }
+
+    bool shouldStop() {
+        if (stopRequested())
+            return true;
+        if ((Parent && Parent->shouldStop()) ||
+            (HasDeadline && std::chrono::steady_clock::now() >= Deadline)) {
+            stop();
+            return true;
+        }
+        return false;
+    }
+
+private:
+    RunControl *Parent = nullptr;
+    std::atomic<bool> Stopped{false};
+    std::atomic<bool> Found{false};
+    bool StopOnFirstFinding = false;
+    bool HasDeadline = false;
+    std::chrono::steady_clock::time_point Deadline;
+};
+
+// Settings of one run, shared by all of its actions. Filled either from the
+// command line by CheckNames or directly by CheckBuffers.
+struct RunConfig {
+    const Dictionary *Dict = nullptr;  // nullptr if typos are not checked
+    RunControl *Control = nullptr;     // nullptr if the run is never interrupted
+    const PolicySet *Policies = &PolicySet::defaults();
+    RenameFixes *Fixes = nullptr;      // nullptr unless -fix is given
+    SummaryCounters *Summary = nullptr;  // Counters of the current task, nullptr unless -summary
+    SkippedLines *Skipped = nullptr;     // Filled while parsing, nullptr unless -all-configs
+    const SkippedLines *OnlySkipped = nullptr;  // Findings elsewhere are dropped, see -all-configs
+};
+
+// Largest number of files parsed as one jumbo translation unit.
+inline constexpr size_t kMaxJumboFiles = 64;
+
+// Last path component, without allocating.
+inline llvm::StringRef baseName(llvm::StringRef Path) {
+    size_t LastSlash = Path.find_last_of("/\\");
+    return LastSlash == llvm::StringRef::npos ? Path : Path.substr(LastSlash + 1);
+}
+
+// Checks a parsed translation unit into Stats once it is complete. Config and
+// Stats must outlive the consumer.
+std::unique_ptr<clang::ASTConsumer> createNameConsumer(clang::ASTContext &Context,
+                                                       Statistics &Stats,
+                                                       const RunConfig &Config);
+
+// Checks every file a tool runs on into StatsMap, keyed by file name; with
+// Members, the tool runs on one jumbo file that includes them all.
+class NameActionFactory : public clang::tooling::FrontendActionFactory {
+public:
+    NameActionFactory(std::unordered_map<std::string, Statistics> &StatsMap, const RunConfig &Config,
+                      std::vector<std::string> Members = {})
+        : StatsMap(StatsMap), Config(Config), Members(std::move(Members)) { }
+    std::unique_ptr<clang::FrontendAction> create() override;
+private:
+    std::unordered_map<std::string, Statistics> &StatsMap;
+    const RunConfig &Config;
+    std::vector<std::string> Members;
+};
+
+// Checks a main file and the quoted includes next to it for typos in quick
+// mode, with the lexer only.
+void scanQuick(Statistics &Stats, const RunConfig &Config, llvm::StringRef Path);
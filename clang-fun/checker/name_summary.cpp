@@ -0,0 +1,152 @@
+#include "name_summary.h"
+#include <algorithm>
+#include <tuple>
+
+using namespace llvm;
+
+void SpaceSaving::add(StringRef Name) {
+    if (!Capacity)
+        return;
+    auto It = Positions.find(Name);
+    if (It != Positions.end()) {
+        size_t Pos = It->second;
+        ++Heap[Pos].Count;
+        siftDown(Pos);
+        return;
+    }
+    if (Heap.size() < Capacity) {
+        auto *Entry = &*Positions.try_emplace(Name, Heap.size()).first;
+        Heap.push_back({Entry, 1, 0});
+        siftUp(Heap.size() - 1);
+        return;
+    }
+
+    // The new name may have been evicted before, up to the smallest count times
+    Slot &Root = Heap.front();
+    size_t Min = Root.Count;
+    Positions.erase(Positions.find(Root.Entry->getKey()));
+    Root = {&*Positions.try_emplace(Name, 0).first, Min + 1, Min};
+    siftDown(0);
+}
+
+void SpaceSaving::merge(const SpaceSaving &Other) {
+    size_t ThisMin = minCount();
+    size_t OtherMin = Other.minCount();
+    StringMap<std::pair<size_t, size_t>> Merged;
+    for (const Slot &S : Heap)
+        Merged[S.Entry->getKey()] = {S.Count + OtherMin, S.Error + OtherMin};
+    for (const Slot &S : Other.Heap) {
+        auto [It, Inserted] = Merged.try_emplace(S.Entry->getKey(), ThisMin, ThisMin);
+        if (!Inserted) {
+            It->second.first -= OtherMin;
+            It->second.second -= OtherMin;
+        }
+        It->second.first += S.Count;
+        It->second.second += S.Error;
+    }
+
+    std::vector<std::tuple<size_t, size_t, StringRef>> Sorted;
+    for (const auto &Entry : Merged)
+        Sorted.emplace_back(Entry.second.first, Entry.second.second, Entry.getKey());
+    std::sort(Sorted.begin(), Sorted.end(), [](const auto &A, const auto &B) {
+        return std::get<0>(A) != std::get<0>(B) ? std::get<0>(A) > std::get<0>(B)
+                                                : std::get<2>(A) < std::get<2>(B);
+    });
+    Sorted.resize(std::min(Sorted.size(), Capacity));
+
+    // Counts in ascending order already form a min-heap
+    Heap.clear();
+    Positions.clear();
+    for (auto It = Sorted.rbegin(); It != Sorted.rend(); ++It) {
+        auto &[Count, Error, Name] = *It;
+        auto *Entry = &*Positions.try_emplace(Name, Heap.size()).first;
+        Heap.push_back({Entry, Count, Error});
+    }
+}
+
+std::vector<TopName> SpaceSaving::top() const {
+    std::vector<TopName> Result;
+    for (const Slot &S : Heap)
+        Result.push_back({S.Entry->getKey().str(), S.Count, S.Error});
+    std::sort(Result.begin(), Result.end(), [](const TopName &A, const TopName &B) {
+        return A.count != B.count ? A.count > B.count : A.name < B.name;
+    });
+    return Result;
+}
+
+void SpaceSaving::place(size_t Pos, Slot S) {
+    S.Entry->second = Pos;
+    Heap[Pos] = S;
+}
+
+void SpaceSaving::siftUp(size_t Pos) {
+    Slot S = Heap[Pos];
+    while (Pos > 0) {
+        size_t Parent = (Pos - 1) / 2;
+        if (Heap[Parent].Count <= S.Count)
+            break;
+        place(Pos, Heap[Parent]);
+        Pos = Parent;
+    }
+    place(Pos, S);
+}
+
+void SpaceSaving::siftDown(size_t Pos) {
+    Slot S = Heap[Pos];
+    while (true) {
+        size_t Child = 2 * Pos + 1;
+        if (Child >= Heap.size())
+            break;
+        if (Child + 1 < Heap.size() && Heap[Child + 1].Count < Heap[Child].Count)
+            ++Child;
+        if (S.Count <= Heap[Child].Count)
+            break;
+        place(Pos, Heap[Child]);
+        Pos = Child;
+    }
+    place(Pos, S);
+}
+
+void SummaryCounters::addBadName(StringRef Directory, Entity EntityType, NameRule Rule,
+                                 StringRef Name) {
+    auto &Counts = Directories[Directory];
+    ++Counts.BadNames[static_cast<size_t>(EntityType) * kNumNameRules + static_cast<size_t>(Rule)];
+    Top.add(Name);
+}
+
+void SummaryCounters::addTypo(StringRef Directory, StringRef Name) {
+    ++Directories[Directory].Typos;
+    Top.add(Name);
+}
+
+void SummaryCounters::merge(const SummaryCounters &Other) {
+    for (const auto &Entry : Other.Directories) {
+        auto &Into = Directories[Entry.getKey()];
+        for (size_t i = 0; i < Into.BadNames.size(); ++i)
+            Into.BadNames[i] += Entry.second.BadNames[i];
+        Into.Typos += Entry.second.Typos;
+    }
+    Top.merge(Other.Top);
+}
+
+void SummaryCounters::exportTo(NameSummary &Summary) const {
+    std::vector<const StringMapEntry<DirectoryCounts> *> Sorted;
+    for (const auto &Entry : Directories)
+        Sorted.push_back(&Entry);
+    std::sort(Sorted.begin(), Sorted.end(),
+              [](const auto *A, const auto *B) { return A->getKey() < B->getKey(); });
+
+    for (const auto *Entry : Sorted) {
+        const DirectoryCounts &Counts = Entry->second;
+        for (size_t Kind = 0; Kind < kNumEntities; ++Kind) {
+            for (size_t Rule = 0; Rule < kNumNameRules; ++Rule) {
+                if (size_t Count = Counts.BadNames[Kind * kNumNameRules + Rule])
+                    Summary.bad_names.push_back({Entry->getKey().str(), static_cast<Entity>(Kind),
+                                                 ruleName(static_cast<NameRule>(Rule)), Count});
+            }
+        }
+        if (Counts.Typos)
+            Summary.typos.emplace_back(Entry->getKey().str(), Counts.Typos);
+    }
+    Summary.top_names = Top.top();
+}
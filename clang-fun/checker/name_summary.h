@@ -0,0 +1,74 @@
+#pragma once
+
+#include "../check_names.h"
+#include "naming_policy.h"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <array>
+#include <vector>
+
+inline constexpr size_t kNumEntities = 5;
+
+// Heavy hitters of a stream of names with the Space-Saving algorithm. At most
+// Capacity names are counted; a new name takes the slot of the least counted
+// one and inherits its count as error. Counts are never below the true count
+// and exceed it by at most their error.
+class SpaceSaving {
+public:
+    explicit SpaceSaving(size_t Capacity) : Capacity(Capacity) {}
+
+    void add(llvm::StringRef Name);
+
+    // Adds the counts of another sketch. A name missing from a full sketch may
+    // have occurred as often as its least counted name, so that count is
+    // added to both its count and its error (mergeable summaries).
+    void merge(const SpaceSaving &Other);
+
+    std::vector<TopName> top() const;  // Most frequent first
+
+private:
+    struct Slot {
+        llvm::StringMapEntry<size_t> *Entry;  // Name and position of the slot in Heap
+        size_t Count;
+        size_t Error;
+    };
+
+    // Zero until the sketch is full; a sketch of no capacity is never full
+    size_t minCount() const {
+        return !Heap.empty() && Heap.size() == Capacity ? Heap.front().Count : 0;
+    }
+    void place(size_t Pos, Slot S);
+    void siftUp(size_t Pos);
+    void siftDown(size_t Pos);
+
+    size_t Capacity;
+    std::vector<Slot> Heap;  // Min-heap by count, the root is evicted first
+    llvm::StringMap<size_t> Positions;
+};
+
+// Counters of one -summary task: bad names per directory, entity and rule,
+// misspelled words per directory and the most frequent offending names.
+// Their size depends only on the number of directories and the capacity of
+// the sketch.
+class SummaryCounters {
+public:
+    explicit SummaryCounters(size_t TopNames) : Top(TopNames) {}
+
+    void addBadName(llvm::StringRef Directory, Entity EntityType, NameRule Rule,
+                    llvm::StringRef Name);
+    void addTypo(llvm::StringRef Directory, llvm::StringRef Name);
+
+    void merge(const SummaryCounters &Other);
+
+    // Fills everything but NameSummary::incomplete.
+    void exportTo(NameSummary &Summary) const;
+
+private:
+    struct DirectoryCounts {
+        std::array<size_t, kNumEntities * kNumNameRules> BadNames{};  // By entity, then rule
+        size_t Typos = 0;
+    };
+
+    llvm::StringMap<DirectoryCounts> Directories;
+    SpaceSaving Top;
+};
@@ -0,0 +1,459 @@
+#include "naming_policy.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringSwitch.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+using namespace llvm;
+
+namespace {
+
+enum CharClass : uint8_t { kLetterK, kLower, kUpper, kDigit, kUnderscore, kOther, kNumClasses };
+
+CharClass classify(unsigned char C) {
+    if (C == 'k')
+        return kLetterK;
+    if (C >= 'a' && C <= 'z')
+        return kLower;
+    if (C >= 'A' && C <= 'Z')
+        return kUpper;
+    if (C >= '0' && C <= '9')
+        return kDigit;
+    if (C == '_')
+        return kUnderscore;
+    return kOther;
+}
+
+// State of the reference matcher that the DFA is compiled from. Only used
+// while compiling: every reachable combination becomes one DFA state.
+struct MatchState {
+    uint8_t Phase = 0;       // Position in the style grammar, 0 before the first character
+    uint8_t Run = 0;         // Length of the current uppercase run, capped at MinUpperRun
+    bool RunCounts = false;  // The current run starts the name or follows a lowercase letter
+    bool PrevLower = false;
+    bool SawLower = false;
+
+    auto key() const { return std::make_tuple(Phase, Run, RunCounts, PrevLower, SawLower); }
+};
+
+bool checksRuns(const RuleSpec &Spec) {
+    return Spec.MinUpperRun > 1;
+}
+
+bool badRun(const RuleSpec &Spec, const MatchState &State) {
+    return checksRuns(Spec) && State.RunCounts && State.Run > 1 && State.Run < Spec.MinUpperRun;
+}
+
+std::optional<uint8_t> nextPhase(const RuleSpec &Spec, uint8_t Phase, CharClass C) {
+    bool Lower = C == kLetterK || C == kLower;
+    bool Digit = C == kDigit && Spec.AllowDigits;
+    switch (Spec.Style) {
+    case NameStyle::kSnakeCase:
+        // 0: start, 1: after a letter or digit, 2: after an underscore
+        if (Lower || (Phase != 0 && Digit))
+            return 1;
+        if (Phase == 1 && C == kUnderscore)
+            return 2;
+        return std::nullopt;
+    case NameStyle::kConstCase:
+        // 0: start, 1: after the 'k', 2: inside the CamelCase part
+        if (Phase == 0)
+            return C == kLetterK ? std::optional<uint8_t>(1) : std::nullopt;
+        if (Phase == 1)
+            return C == kUpper ? std::optional<uint8_t>(2) : std::nullopt;
+        if (Lower || C == kUpper || Digit)
+            return 2;
+        return std::nullopt;
+    case NameStyle::kCamelCase:
+        // 0: start, 1: inside the name
+        if (Phase == 0)
+            return C == kUpper ? std::optional<uint8_t>(1) : std::nullopt;
+        if (Lower || C == kUpper || Digit)
+            return 1;
+        return std::nullopt;
+    }
+    return std::nullopt;
+}
+
+std::optional<MatchState> step(const RuleSpec &Spec, const MatchState &State, CharClass C) {
+    auto Phase = nextPhase(Spec, State.Phase, C);
+    if (!Phase)
+        return std::nullopt;
+
+    MatchState Next = State;
+    Next.Phase = *Phase;
+    bool Lower = C == kLetterK || C == kLower;
+    if (checksRuns(Spec)) {
+        if (C == kUpper) {
+            if (State.Run == 0)
+                Next.RunCounts = State.Phase == 0 || State.PrevLower;
+            Next.Run = std::min<unsigned>(State.Run + 1, Spec.MinUpperRun);
+        } else {
+            if (badRun(Spec, State))
+                return std::nullopt;
+            Next.Run = 0;
+            Next.RunCounts = false;
+        }
+    }
+    Next.PrevLower = Lower;
+    Next.SawLower = State.SawLower || Lower;
+    return Next;
+}
+
+bool accepts(const RuleSpec &Spec, const MatchState &State) {
+    bool PhaseAccepts = false;
+    switch (Spec.Style) {
+    case NameStyle::kSnakeCase:
+        PhaseAccepts = (State.Phase == 1 && Spec.Trailing != TrailingUnderscore::kRequire) ||
+                       (State.Phase == 2 && Spec.Trailing != TrailingUnderscore::kForbid);
+        break;
+    case NameStyle::kConstCase:
+        PhaseAccepts = State.Phase == 2;
+        break;
+    case NameStyle::kCamelCase:
+        PhaseAccepts = State.Phase == 1;
+        break;
+    }
+    return PhaseAccepts && (Spec.AllowAllUpper || State.SawLower) && !badRun(Spec, State);
+}
+
+std::array<RuleSpec, kNumNameRules> defaultSpecs() {
+    std::array<RuleSpec, kNumNameRules> Specs;
+    auto Spec = [&Specs](NameRule Rule) -> RuleSpec & {
+        return Specs[static_cast<size_t>(Rule)];
+    };
+
+    Spec(NameRule::kPrivateField).Trailing = TrailingUnderscore::kRequire;
+    Spec(NameRule::kConst).Style = NameStyle::kConstCase;
+    Spec(NameRule::kConstexprFunction).Style = NameStyle::kConstCase;
+
+    auto &Type = Spec(NameRule::kType);
+    Type.Style = NameStyle::kCamelCase;
+    Type.MinUpperRun = 3;
+    Type.AllowAllUpper = false;
+
+    auto &Method = Spec(NameRule::kMethod);
+    Method.Style = NameStyle::kCamelCase;
+    Method.MinLength = 2;
+
+    auto &Snake = Spec(NameRule::kSnakeFunction);
+    Snake.Trailing = TrailingUnderscore::kAllow;
+    Snake.ForbiddenPrefixes = {"is_", "has_", "can_", "should_", "does_", "was_", "get_", "set_"};
+
+    auto &Camel = Spec(NameRule::kCamelFunction);
+    Camel.Style = NameStyle::kCamelCase;
+    Camel.MinUpperRun = 3;
+    Camel.AllowAllUpper = false;
+    Camel.MinLength = 2;
+    return Specs;
+}
+
+std::optional<NameRule> parseRule(StringRef Name) {
+    for (size_t Rule = 0; Rule < kNumNameRules; ++Rule)
+        if (Name == ruleName(static_cast<NameRule>(Rule)))
+            return static_cast<NameRule>(Rule);
+    return std::nullopt;
+}
+
+std::optional<bool> parseAllow(StringRef Value) {
+    return StringSwitch<std::optional<bool>>(Value)
+        .Case("allow", true)
+        .Case("forbid", false)
+        .Default(std::nullopt);
+}
+
+bool applyToSpec(RuleSpec &Spec, StringRef Key, StringRef Value) {
+    if (Key == "style") {
+        auto Style = StringSwitch<std::optional<NameStyle>>(Value)
+                         .Case("snake_case", NameStyle::kSnakeCase)
+                         .Case("CamelCase", NameStyle::kCamelCase)
+                         .Case("kCamelCase", NameStyle::kConstCase)
+                         .Default(std::nullopt);
+        if (!Style)
+            return false;
+        Spec.Style = *Style;
+    } else if (Key == "trailing-underscore") {
+        auto Trailing = StringSwitch<std::optional<TrailingUnderscore>>(Value)
+                            .Case("forbid", TrailingUnderscore::kForbid)
+                            .Case("require", TrailingUnderscore::kRequire)
+                            .Case("allow", TrailingUnderscore::kAllow)
+                            .Default(std::nullopt);
+        if (!Trailing)
+            return false;
+        Spec.Trailing = *Trailing;
+    } else if (Key == "digits" || Key == "all-upper") {
+        auto Allow = parseAllow(Value);
+        if (!Allow)
+            return false;
+        (Key == "digits" ? Spec.AllowDigits : Spec.AllowAllUpper) = *Allow;
+    } else if (Key == "min-upper-run" || Key == "min-length") {
+        unsigned Number;
+        if (Value.getAsInteger(10, Number) || Number > 64)
+            return false;
+        (Key == "min-upper-run" ? Spec.MinUpperRun : Spec.MinLength) = Number;
+    } else if (Key == "forbidden-prefixes") {
+        SmallVector<StringRef, 8> Prefixes;
+        Value.split(Prefixes, ',', -1, /*KeepEmpty=*/false);
+        Spec.ForbiddenPrefixes.clear();
+        for (StringRef Prefix : Prefixes)
+            Spec.ForbiddenPrefixes.push_back(Prefix.trim().str());
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Applies "<rule>.<key> = value" to one rule, or "<key> = value" to all of them.
+bool applySetting(std::array<RuleSpec, kNumNameRules> &Specs, StringRef Key, StringRef Value) {
+    auto [RuleName, RuleKey] = Key.split('.');
+    if (RuleKey.empty()) {
+        for (auto &Spec : Specs)
+            if (!applyToSpec(Spec, Key, Value))
+                return false;
+        return true;
+    }
+    auto Rule = parseRule(RuleName);
+    return Rule && applyToSpec(Specs[static_cast<size_t>(*Rule)], RuleKey, Value);
+}
+
+// Splits an identifier into words at underscores and case changes:
+// XMLHttpRequest_v2 gives XML, Http, Request, v2.
+SmallVector<StringRef, 8> splitWords(StringRef Name) {
+    SmallVector<StringRef, 8> Words;
+    size_t Begin = 0;
+    auto Flush = [&](size_t End) {
+        if (End > Begin)
+            Words.push_back(Name.slice(Begin, End));
+        Begin = End;
+    };
+    for (size_t i = 0; i < Name.size(); ++i) {
+        CharClass C = classify(Name[i]);
+        if (C == kUnderscore) {
+            Flush(i);
+            Begin = i + 1;
+            continue;
+        }
+        if (i == Begin || C != kUpper)
+            continue;
+        CharClass Prev = classify(Name[i - 1]);
+        bool NextLower = i + 1 < Name.size() &&
+                         (classify(Name[i + 1]) == kLower || classify(Name[i + 1]) == kLetterK);
+        // A new word starts at "aB" and at the last capital of "ABc"
+        if (Prev != kUpper || NextLower)
+            Flush(i);
+    }
+    Flush(Name.size());
+    return Words;
+}
+
+bool isInDirectory(StringRef Path, StringRef Directory) {
+    return Path.startswith(Directory) &&
+           (Path.size() == Directory.size() || sys::path::is_separator(Path[Directory.size()]));
+}
+
+} // namespace
+
+const char *ruleName(NameRule Rule) {
+    switch (Rule) {
+    case NameRule::kVariable:
+        return "variable";
+    case NameRule::kPublicField:
+        return "public-field";
+    case NameRule::kPrivateField:
+        return "private-field";
+    case NameRule::kConst:
+        return "const";
+    case NameRule::kType:
+        return "type";
+    case NameRule::kMethod:
+        return "method";
+    case NameRule::kSnakeFunction:
+        return "snake-function";
+    case NameRule::kCamelFunction:
+        return "camel-function";
+    case NameRule::kConstexprFunction:
+        return "constexpr-function";
+    }
+    return "unknown";
+}
+
+CompiledRule::CompiledRule(const RuleSpec &Spec)
+    : MinLength(Spec.MinLength), ForbiddenPrefixes(Spec.ForbiddenPrefixes) {
+    for (unsigned C = 0; C < 256; ++C)
+        Classes[C] = classify(C);
+
+    // State 0 is the start state and state 1 rejects everything.
+    std::map<decltype(MatchState{}.key()), uint16_t> Ids;
+    std::vector<MatchState> States = {MatchState{}, MatchState{}};
+    Ids.emplace(States[0].key(), 0);
+    Next.assign(2, {});
+    Accepting.assign(2, 0);
+    Next[1].fill(1);
+
+    for (size_t Id = 0; Id < States.size(); ++Id) {
+        if (Id == 1)
+            continue;
+        for (unsigned C = 0; C < kNumClasses; ++C) {
+            auto To = step(Spec, States[Id], static_cast<CharClass>(C));
+            uint16_t ToId = 1;
+            if (To) {
+                auto [It, Inserted] = Ids.emplace(To->key(), States.size());
+                if (Inserted) {
+                    States.push_back(*To);
+                    Next.emplace_back();
+                    Accepting.push_back(accepts(Spec, *To));
+                }
+                ToId = It->second;
+            }
+            Next[Id][C] = ToId;
+        }
+    }
+}
+
+bool CompiledRule::matches(StringRef Name) const {
+    if (Name.size() < MinLength)
+        return false;
+    uint16_t State = 0;
+    for (unsigned char C : Name)
+        State = Next[State][Classes[C]];
+    if (!Accepting[State])
+        return false;
+    for (const auto &Prefix : ForbiddenPrefixes)
+        if (Name.startswith(Prefix))
+            return false;
+    return true;
+}
+
+NamingPolicy::NamingPolicy(const std::array<RuleSpec, kNumNameRules> &Specs) : Specs(Specs) {
+    for (size_t i = 0; i < kNumNameRules; ++i)
+        Rules[i] = CompiledRule(Specs[i]);
+}
+
+std::string NamingPolicy::fixName(NameRule Rule, StringRef Name) const {
+    const RuleSpec &Spec = Specs[static_cast<size_t>(Rule)];
+    SmallVector<StringRef, 8> Words = splitWords(Name);
+    std::string Fixed;
+    switch (Spec.Style) {
+    case NameStyle::kSnakeCase:
+        for (StringRef Word : Words) {
+            if (!Fixed.empty())
+                Fixed += '_';
+            Fixed += Word.lower();
+        }
+        if (Spec.Trailing == TrailingUnderscore::kRequire)
+            Fixed += '_';
+        break;
+    case NameStyle::kConstCase:
+        Fixed = "k";
+        // Drop the 'k' of a misspelled constant such as k_max_size or KMaxSize
+        if (!Words.empty() && Words.front().equals_insensitive("k"))
+            Words.erase(Words.begin());
+        [[fallthrough]];
+    case NameStyle::kCamelCase: {
+        // Acronyms are kept as they are, unless the whole name is uppercase
+        bool HasLower = Name.upper() != Name;
+        for (StringRef Word : Words) {
+            bool Acronym = HasLower && Word.size() > 1 && Word.size() >= Spec.MinUpperRun &&
+                           Word.upper() == Word;
+            Fixed += Acronym ? Word.str() : Word.substr(0, 1).upper() + Word.substr(1).lower();
+        }
+        break;
+    }
+    }
+    if (Fixed == Name || !matches(Rule, Fixed))
+        return {};
+    return Fixed;
+}
+
+PolicySet::PolicySet() : Global(std::make_unique<NamingPolicy>(defaultSpecs())) {}
+
+const PolicySet &PolicySet::defaults() {
+    static const PolicySet Defaults;
+    return Defaults;
+}
+
+bool PolicySet::loadFromFile(const std::string &Path) {
+    auto BufferOrErr = MemoryBuffer::getFile(Path);
+    if (!BufferOrErr) {
+        errs() << "check_names: cannot read naming config " << Path << ": "
+               << BufferOrErr.getError().message() << "\n";
+        return false;
+    }
+
+    SmallString<256> BaseDir(Path);
+    sys::fs::make_absolute(BaseDir);
+    sys::path::remove_filename(BaseDir);
+
+    using Settings = std::vector<std::pair<std::string, std::string>>;
+    Settings GlobalSettings;
+    std::vector<std::pair<std::string, Settings>> SectionSettings;
+    Settings *Current = &GlobalSettings;
+
+    SmallVector<StringRef, 64> Lines;
+    (*BufferOrErr)->getBuffer().split(Lines, '\n');
+    for (size_t LineNo = 0; LineNo < Lines.size(); ++LineNo) {
+        StringRef Line = Lines[LineNo].split('#').first.trim();
+        if (Line.empty())
+            continue;
+
+        if (Line.startswith("[") && Line.endswith("]")) {
+            SmallString<256> Dir(Line.drop_front().drop_back().trim());
+            sys::fs::make_absolute(BaseDir, Dir);
+            sys::path::remove_dots(Dir, /*remove_dot_dot=*/true);
+            while (Dir.size() > 1 && sys::path::is_separator(Dir.back()))
+                Dir.pop_back();
+            SectionSettings.emplace_back(std::string(Dir), Settings{});
+            Current = &SectionSettings.back().second;
+            continue;
+        }
+
+        auto [Key, Value] = Line.split('=');
+        Key = Key.trim();
+        Value = Value.trim();
+        // Validate right away so that errors point at the offending line
+        auto Scratch = defaultSpecs();
+        if (Key.empty() || Value.empty() || !applySetting(Scratch, Key, Value)) {
+            errs() << Path << ":" << LineNo + 1 << ": invalid naming setting '" << Line << "'\n";
+            return false;
+        }
+        Current->emplace_back(Key.str(), Value.str());
+    }
+
+    auto GlobalSpecs = defaultSpecs();
+    for (const auto &[Key, Value] : GlobalSettings)
+        applySetting(GlobalSpecs, Key, Value);
+
+    // Outer directories first, so that inner sections override them
+    std::stable_sort(SectionSettings.begin(), SectionSettings.end(),
+                     [](const auto &A, const auto &B) { return A.first.size() < B.first.size(); });
+    std::vector<Section> NewSections;
+    for (const auto &[Dir, Own] : SectionSettings) {
+        auto Specs = GlobalSpecs;
+        for (const auto &[Outer, OuterSettings] : SectionSettings) {
+            if (!isInDirectory(Dir, Outer))
+                continue;
+            for (const auto &[Key, Value] : OuterSettings)
+                applySetting(Specs, Key, Value);
+        }
+        NewSections.push_back({Dir, std::make_unique<NamingPolicy>(Specs)});
+    }
+    std::reverse(NewSections.begin(), NewSections.end());
+
+    Global = std::make_unique<NamingPolicy>(GlobalSpecs);
+    Sections = std::move(NewSections);
+    return true;
+}
+
+const NamingPolicy &PolicySet::forFile(StringRef Path) const {
+    for (const auto &S : Sections)
+        if (isInDirectory(Path, S.Directory))
+            return *S.Policy;
+    return *Global;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <llvm/ADT/StringRef.h>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Kinds of declarations that have their own naming rule.
+enum class NameRule : uint8_t {
+    kVariable,           // Local and global variables, parameters
+    kPublicField,        // Members of structs and unions
+    kPrivateField,       // Members of classes
+    kConst,              // const and constexpr variables and members
+    kType,               // Classes, structs, enums, typedefs
+    kMethod,             // Member functions
+    kSnakeFunction,      // Free functions spelled starting with a lowercase letter
+    kCamelFunction,      // Free functions spelled starting with an uppercase letter
+    kConstexprFunction,  // constexpr functions
+};
+
+inline constexpr size_t kNumNameRules = 9;
+
+// Name of the rule in config files, e.g. "private-field".
+const char *ruleName(NameRule Rule);
+
+enum class NameStyle : uint8_t {
+    kSnakeCase,  // lower_case
+    kCamelCase,  // CamelCase
+    kConstCase,  // kCamelCase
+};
+
+enum class TrailingUnderscore : uint8_t { kForbid, kRequire, kAllow };
+
+// Declarative description of one rule, as written in a config file.
+struct RuleSpec {
+    NameStyle Style = NameStyle::kSnakeCase;
+    TrailingUnderscore Trailing = TrailingUnderscore::kForbid;
+    bool AllowDigits = false;
+    // Uppercase runs that start a name or follow a lowercase letter must be
+    // at least this long, unless they are a single letter. 0 disables the check.
+    unsigned MinUpperRun = 0;
+    bool AllowAllUpper = true;  // Whether a name without lowercase letters is allowed
+    unsigned MinLength = 1;
+    std::vector<std::string> ForbiddenPrefixes;
+};
+
+// A rule compiled into a DFA over character classes. Checking a name is one
+// table lookup per character plus the (usually empty) list of prefixes.
+class CompiledRule {
+public:
+    CompiledRule() = default;
+    explicit CompiledRule(const RuleSpec &Spec);
+
+    bool matches(llvm::StringRef Name) const;
+
+private:
+    std::array<uint8_t, 256> Classes{};
+    std::vector<std::array<uint16_t, 6>> Next;
+    std::vector<uint8_t> Accepting;
+    unsigned MinLength = 1;
+    std::vector<std::string> ForbiddenPrefixes;
+};
+
+// One compiled rule per NameRule, used as a dispatch table.
+class NamingPolicy {
+public:
+    explicit NamingPolicy(const std::array<RuleSpec, kNumNameRules> &Specs);
+
+    bool matches(NameRule Rule, llvm::StringRef Name) const {
+        return Rules[static_cast<size_t>(Rule)].matches(Name);
+    }
+
+    // Respells the words of the name in the style of the rule, e.g. BitLen
+    // becomes bit_len for variables. Returns an empty string if the result
+    // would still break the rule (digits, forbidden prefixes, ...).
+    std::string fixName(NameRule Rule, llvm::StringRef Name) const;
+
+private:
+    std::array<RuleSpec, kNumNameRules> Specs;
+    std::array<CompiledRule, kNumNameRules> Rules;
+};
+
+// The default policy plus per-directory overrides from a config file.
+//
+// Config format, one setting per line, '#' starts a comment:
+//
+//   [dir/relative/to/config]         start of a per-directory section
+//   <rule>.<key> = <value>           setting for one rule
+//   <key> = <value>                  setting for every rule
+//
+// Rules: variable, public-field, private-field, const, type, method,
+// snake-function, camel-function, constexpr-function.
+// Keys: style (snake_case, CamelCase, kCamelCase), trailing-underscore
+// (forbid, require, allow), digits (forbid, allow), min-upper-run (number),
+// all-upper (forbid, allow), min-length (number), forbidden-prefixes
+// (comma-separated list).
+//
+// Settings before the first section apply everywhere. A file gets every
+// section whose directory contains it, outer directories first.
+class PolicySet {
+public:
+    PolicySet();
+
+    // Replaces the current policies. Prints errors and returns false on failure.
+    bool loadFromFile(const std::string &Path);
+
+    // Policy of the innermost configured directory containing the file.
+    const NamingPolicy &forFile(llvm::StringRef Path) const;
+
+    static const PolicySet &defaults();
+
+private:
+    struct Section {
+        std::string Directory;  // Absolute, without trailing separator
+        std::unique_ptr<NamingPolicy> Policy;
+    };
+
+    std::unique_ptr<NamingPolicy> Global;
+    std::vector<Section> Sections;  // Longest directory first
+};
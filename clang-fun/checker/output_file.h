@@ -0,0 +1,22 @@
+#pragma once
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+
+// Closes a file that check_names wrote and reports a failed write, e.g. on a
+// full disk. raw_fd_ostream aborts the process (inside the plugin, the
+// compiler) on an error nobody looked at, so the error is cleared, and the
+// partial file is removed so that it is not read as complete.
+inline bool closeOutput(llvm::raw_fd_ostream &Out, llvm::StringRef Path,
+                        llvm::StringRef What) {
+    Out.close();
+    if (!Out.has_error())
+        return true;
+    llvm::errs() << "check_names: cannot write " << What << " " << Path << ": "
+                 << Out.error().message() << "\n";
+    Out.clear_error();
+    if (llvm::sys::fs::is_regular_file(Path))
+        llvm::sys::fs::remove(Path);
+    return false;
+}
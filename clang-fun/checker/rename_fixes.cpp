@@ -0,0 +1,144 @@
+#include "rename_fixes.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <iterator>
+#include <vector>
+
+using namespace clang::tooling;
+using namespace llvm;
+
+namespace {
+
+// Start to end of the edits taken in one file. Edits that merely touch count
+// as overlapping too: insertions next to a rename would change its text.
+using TakenRanges = std::map<unsigned, unsigned>;
+
+bool overlaps(const TakenRanges &Taken, const Replacement &R) {
+    unsigned Start = R.getOffset(), End = R.getOffset() + R.getLength();
+    // Taken ranges do not overlap, so the last one starting before End
+    // reaches furthest
+    auto It = Taken.upper_bound(End);
+    return It != Taken.begin() && std::prev(It)->second >= Start;
+}
+
+} // namespace
+
+void RenameFixes::add(const std::string &Rename, const Replacements &Replaces) {
+    // Resolve paths before taking the lock; a translation unit touches few files.
+    StringMap<std::string> RealPaths;
+    std::vector<std::pair<std::string *, Replacement>> Resolved;
+    for (const Replacement &R : Replaces) {
+        auto [It, Inserted] = RealPaths.try_emplace(R.getFilePath());
+        if (Inserted) {
+            SmallString<256> RealPath;
+            It->second = sys::fs::real_path(R.getFilePath(), RealPath)
+                             ? R.getFilePath().str()
+                             : std::string(RealPath);
+        }
+        Resolved.emplace_back(&It->second,
+                              Replacement(It->second, R.getOffset(), R.getLength(),
+                                          R.getReplacementText()));
+    }
+
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto &Edits = Renames[Rename];
+    for (auto &[Path, R] : Resolved)
+        Edits[*Path].insert(std::move(R));
+}
+
+void RenameFixes::veto(const std::string &Rename) {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    Vetoed.insert(Rename);
+}
+
+RenameFixes::Summary RenameFixes::apply(ThreadPool &Pool) {
+    Summary Total;
+
+    // Take whole renames. Identical edits of one rename are already merged by
+    // its sets; an overlap with an earlier rename or within the rename itself
+    // drops all of its edits in every file.
+    std::map<std::string, Replacements> Taken;
+    std::map<std::string, TakenRanges> TakenRangesByFile;
+    for (const auto &[Rename, Edits] : Renames) {
+        if (Vetoed.count(Rename)) {
+            ++Total.Clashes;
+            continue;
+        }
+        bool Conflict = false;
+        std::map<std::string, Replacements> Own;
+        for (const auto &[Path, FileEdits] : Edits) {
+            const auto &Ranges = TakenRangesByFile[Path];
+            for (const Replacement &R : FileEdits) {
+                if (overlaps(Ranges, R)) {
+                    Conflict = true;
+                } else if (auto Err = Own[Path].add(R)) {
+                    consumeError(std::move(Err));
+                    Conflict = true;
+                }
+            }
+        }
+        if (Conflict) {
+            ++Total.Conflicts;
+            continue;
+        }
+        for (const auto &[Path, FileEdits] : Own) {
+            auto &Ranges = TakenRangesByFile[Path];
+            for (const Replacement &R : FileEdits) {
+                Ranges.emplace(R.getOffset(), R.getOffset() + R.getLength());
+                // Cannot fail: the edit overlaps nothing taken before
+                cantFail(Taken[Path].add(R));
+            }
+        }
+    }
+
+    std::vector<Summary> PerFile(Taken.size());
+    size_t Index = 0;
+    for (const auto &Entry : Taken) {
+        Pool.async([&Entry, &FileSummary = PerFile[Index++]] {
+            const auto &[Path, Merged] = Entry;
+            auto BufferOrErr = MemoryBuffer::getFile(Path);
+            if (!BufferOrErr) {
+                errs() << "check_names: cannot read " << Path << ": "
+                       << BufferOrErr.getError().message() << "\n";
+                return;
+            }
+            auto Fixed = applyAllReplacements((*BufferOrErr)->getBuffer(), Merged);
+            if (!Fixed) {
+                errs() << "check_names: cannot fix " << Path << ": "
+                       << toString(Fixed.takeError()) << "\n";
+                return;
+            }
+            BufferOrErr->reset();
+
+            std::error_code EC;
+            raw_fd_ostream Out(Path, EC);
+            if (EC) {
+                errs() << "check_names: cannot write " << Path << ": " << EC.message() << "\n";
+                return;
+            }
+            Out << *Fixed;
+            Out.close();
+            if (Out.has_error()) {
+                // The source file is the user's, so it is not removed
+                errs() << "check_names: cannot write " << Path << ": "
+                       << Out.error().message() << "\n";
+                Out.clear_error();
+                return;
+            }
+            FileSummary.Files = 1;
+            FileSummary.Edits = Merged.size();
+        });
+    }
+    Pool.wait();
+
+    for (const auto &S : PerFile) {
+        Total.Files += S.Files;
+        Total.Edits += S.Edits;
+    }
+    Renames.clear();
+    Vetoed.clear();
+    return Total;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <clang/Tooling/Core/Replacement.h>
+#include <llvm/Support/ThreadPool.h>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+// Rename edits of a -fix run, collected from every translation unit. A header
+// included by many translation units produces the same edits in each of them;
+// they are kept once and every file is rewritten in a single write.
+//
+// Edits are grouped by rename, identified by the USR of the declaration and
+// the new name, and a rename is applied either with all of its edits or not
+// at all, so a conflict never leaves code half renamed.
+class RenameFixes {
+public:
+    struct Summary {
+        size_t Files = 0;      // Files rewritten
+        size_t Edits = 0;      // Edits applied
+        size_t Conflicts = 0;  // Renames dropped because they overlap an earlier one
+        size_t Clashes = 0;    // Renames dropped because the new name is taken somewhere
+    };
+
+    // Adds the edits of one rename in one translation unit. Safe to call from
+    // several workers.
+    void add(const std::string &Rename, const clang::tooling::Replacements &Replaces);
+
+    // Drops the rename in every translation unit: in one of them the new name
+    // would clash with an existing declaration.
+    void veto(const std::string &Rename);
+
+    // Applies all collected renames, one file per task of the pool. Renames
+    // are taken in order of their keys, and one whose edits overlap those
+    // already taken is dropped.
+    Summary apply(llvm::ThreadPool &Pool);
+
+private:
+    // Edits of one rename, keyed and ordered by the real path, so that one
+    // file reached through different relative paths is still edited once.
+    using FileEdits = std::map<std::string, std::set<clang::tooling::Replacement>>;
+
+    std::mutex Mutex;
+    std::map<std::string, FileEdits> Renames;
+    std::set<std::string> Vetoed;
+};
@@ -0,0 +1,690 @@
+#include "../check_names.h"
+#include "baseline.h"
+#include "caching_fs.h"
+#include "name_checker.h"
+#include "name_summary.h"
+#include "naming_policy.h"
+#include "output_file.h"
+#include "rename_fixes.h"
+#include "sampling.h"
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Tooling/CommonOptionsParser.h>
+#include <clang/Tooling/CompilationDatabase.h>
+#include <clang/Tooling/Tooling.h>
+#include <llvm/ADT/ArrayRef.h>
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Support/CommandLine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/Threading.h>
+#include <llvm/Support/VirtualFileSystem.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+
+// Command line options
+static cl::OptionCategory CheckNamesCategory("Check Names options");
+static cl::opt<std::string> DictionaryPath("dict", cl::desc("Path to dictionary file"), cl::cat(CheckNamesCategory));
+static cl::opt<std::string> BaselinePath("baseline", cl::desc("Do not report violations listed in this baseline file"), cl::cat(CheckNamesCategory));
+static cl::opt<bool> FailFast("fail-fast", cl::desc("Stop all workers at the first reported violation"), cl::cat(CheckNamesCategory));
+static cl::opt<unsigned> DeadlineMs("deadline", cl::desc("Return partial results after this many milliseconds"), cl::value_desc("ms"), cl::init(0), cl::cat(CheckNamesCategory));
+static cl::opt<unsigned> Jobs("j", cl::desc("Number of files checked in parallel"), cl::init(1), cl::cat(CheckNamesCategory));
+static cl::opt<std::string> WriteBaselinePath("write-baseline", cl::desc("Write all found violations to this baseline file"), cl::cat(CheckNamesCategory));
+static cl::opt<std::string> WriteStatsPath("write-stats", cl::desc("Write the results to this file in binary form"), cl::cat(CheckNamesCategory));
+static cl::opt<std::string> SummaryPath("summary", cl::desc("Only count violations per directory, entity and rule, and the most frequent bad names, and write the counts to this file"), cl::cat(CheckNamesCategory));
+static cl::opt<unsigned> SummaryTop("summary-top", cl::desc("Number of most frequent bad names kept by -summary"), cl::init(20), cl::cat(CheckNamesCategory));
+static cl::opt<unsigned> JumboSize("jumbo", cl::desc("Parse up to this many files with the same compile command as one translation unit"), cl::value_desc("files"), cl::init(0), cl::cat(CheckNamesCategory));
+static cl::opt<bool> AllConfigs("all-configs", cl::desc("Also check the lines that the other compile commands of a file enable, e.g. with other macros"), cl::cat(CheckNamesCategory));
+static cl::opt<std::string> Sample("sample", cl::desc("Only check a sample of the files stratified by directory: a fraction such as 0.05 or a number of files. The sample has exactly this size; with fewer files than directories, some directories are left out"), cl::value_desc("fraction|count"), cl::cat(CheckNamesCategory));
+static cl::opt<unsigned> SampleSeed("sample-seed", cl::desc("Seed that picks the files of -sample"), cl::init(0), cl::cat(CheckNamesCategory));
+static cl::opt<std::string> EstimatePath("estimate", cl::desc("Estimate violation rates from the checked files and write them to this file"), cl::cat(CheckNamesCategory));
+static cl::opt<bool> Fix("fix", cl::desc("Rename badly named declarations and their references in place"), cl::cat(CheckNamesCategory));
+static cl::opt<bool> Quick("quick", cl::desc("Only look for typos, finding declarations with the lexer instead of parsing. Style violations are not reported, and a name is checked if it follows any naming rule"), cl::cat(CheckNamesCategory));
+static cl::opt<std::string> NamingConfigPath("naming-config", cl::desc("Path to naming policy config with per-directory rules"), cl::cat(CheckNamesCategory));
+
+static bool hasFindings(const std::unordered_map<std::string, Statistics> &StatsMap) {
+    return std::any_of(StatsMap.begin(), StatsMap.end(), [](const auto &Entry) {
+        return !Entry.second.bad_names.empty() || !Entry.second.mistakes.empty();
+    });
+}
+
+// Most recently modified files first; files that cannot be stat'ed go last.
+static void sortByModificationTime(std::vector<std::string> &Files) {
+    std::vector<std::pair<sys::TimePoint<>, std::string>> Stamped;
+    for (auto &File : Files) {
+        sys::fs::file_status Status;
+        sys::TimePoint<> Modified;
+        if (!sys::fs::status(File, Status))
+            Modified = Status.getLastModificationTime();
+        Stamped.emplace_back(Modified, std::move(File));
+    }
+    std::stable_sort(Stamped.begin(), Stamped.end(), [](const auto &A, const auto &B) {
+        return A.first > B.first;
+    });
+    for (size_t i = 0; i < Files.size(); ++i)
+        Files[i] = std::move(Stamped[i].second);
+}
+
+// Compile command key of a file for jumbo batches: the command without the
+// file itself and its output.
+static std::string jumboKey(const CompileCommand &Command) {
+    std::string Key = Command.Directory;
+    for (size_t i = 0; i < Command.CommandLine.size(); ++i) {
+        StringRef Arg = Command.CommandLine[i];
+        if (Arg == Command.Filename)
+            continue;
+        if (Arg == "-o") {
+            ++i;
+            continue;
+        }
+        if (Arg.startswith("-o"))
+            continue;
+        Key += '\0';
+        Key += Arg;
+    }
+    return Key;
+}
+
+// Key of the configuration a compile command parses its file in: the command
+// without the file, its outputs and the flags that only affect code
+// generation, warnings or dependency files. Debug and release variants that
+// differ only in -O and -g have the same key, while different -D flags,
+// include paths or language modes do not.
+static std::string configurationKey(const CompileCommand &Command) {
+    std::string Key = Command.Directory;
+    for (size_t i = 0; i < Command.CommandLine.size(); ++i) {
+        StringRef Arg = Command.CommandLine[i];
+        if (Arg == Command.Filename || Arg == "-c" || Arg == "-w" || Arg == "-pipe")
+            continue;
+        if (Arg == "-o" || Arg == "-MF" || Arg == "-MT" || Arg == "-MQ") {
+            ++i;
+            continue;
+        }
+        if (Arg.startswith("-o") || Arg.startswith("-O") || Arg.startswith("-g") ||
+            Arg.startswith("-M") || Arg.startswith("-fdiagnostics") ||
+            Arg.startswith("-fcolor-diagnostics") ||
+            (Arg.startswith("-W") && !Arg.startswith("-Wp,")))
+            continue;
+        Key += '\0';
+        Key += Arg;
+    }
+    return Key;
+}
+
+// The first command of every configuration of a file, in database order.
+static std::vector<CompileCommand> distinctConfigurations(std::vector<CompileCommand> Commands) {
+    std::vector<CompileCommand> Configurations;
+    StringSet<> Seen;
+    for (auto &Command : Commands) {
+        if (Seen.insert(configurationKey(Command)).second)
+            Configurations.push_back(std::move(Command));
+    }
+    return Configurations;
+}
+
+// Groups files with the same first configuration into batches of at most
+// Size files, keeping the order of Files. Files without a compile command
+// get a batch of their own. Files of a batch have different names, since
+// their results are keyed by name.
+static std::vector<std::vector<size_t>> jumboBatches(
+    const std::vector<std::vector<CompileCommand>> &Configurations,
+    const std::vector<std::string> &Files, size_t Size) {
+    Size = std::min(Size, kMaxJumboFiles);
+    std::vector<std::vector<size_t>> Batches;
+    StringMap<size_t> Filling;  // Batch still taking files, by compile command
+    for (size_t i = 0; i < Files.size(); ++i) {
+        if (Size <= 1 || Configurations[i].empty()) {
+            Batches.push_back({i});
+            continue;
+        }
+        auto [It, Inserted] = Filling.try_emplace(jumboKey(Configurations[i].front()),
+                                                  Batches.size());
+        if (!Inserted) {
+            auto &Batch = Batches[It->second];
+            bool Fits = Batch.size() < Size &&
+                        std::none_of(Batch.begin(), Batch.end(), [&](size_t j) {
+                            return baseName(Files[j]) == baseName(Files[i]);
+                        });
+            if (Fits) {
+                Batch.push_back(i);
+                continue;
+            }
+            It->second = Batches.size();
+        }
+        Batches.push_back({i});
+    }
+    return Batches;
+}
+
+// Hands out one compile command for any file.
+class SingleCommandDatabase : public CompilationDatabase {
+public:
+    explicit SingleCommandDatabase(CompileCommand Command) : Command(std::move(Command)) {}
+    std::vector<CompileCommand> getCompileCommands(StringRef) const override { return {Command}; }
+
+private:
+    CompileCommand Command;
+};
+
+// Tool for the given files that reads from disk through the cache of the run.
+static std::unique_ptr<ClangTool> newTool(const CompilationDatabase &Compilations,
+                                          ArrayRef<std::string> Files, FileSystemCache &Cache) {
+    return std::make_unique<ClangTool>(Compilations, Files,
+                                       std::make_shared<PCHContainerOperations>(),
+                                       IntrusiveRefCntPtr<vfs::FileSystem>(
+                                           new CachingFileSystem(Cache)));
+}
+
+// Checks a file under its first configuration, or under whatever the
+// database has for it if there is none.
+static void checkFile(const CompilationDatabase &Compilations,
+                      const std::vector<CompileCommand> &Configurations, const std::string &File,
+                      std::unordered_map<std::string, Statistics> &Result,
+                      const RunConfig &Config, FileSystemCache &Cache) {
+    NameActionFactory Factory(Result, Config);
+    if (Configurations.empty()) {
+        newTool(Compilations, {File}, Cache)->run(&Factory);
+        return;
+    }
+    SingleCommandDatabase First(Configurations.front());
+    newTool(First, {File}, Cache)->run(&Factory);
+}
+
+// Appends the findings of From that Into does not have yet.
+template <class Finding, class KeyFn>
+static void appendNew(std::vector<Finding> &Into, std::vector<Finding> &From, KeyFn Key) {
+    auto Less = [&](size_t A, size_t B) { return Key(Into[A]) < Key(Into[B]); };
+    std::set<size_t, decltype(Less)> Seen(Less);
+    for (size_t i = 0; i < Into.size(); ++i)
+        Seen.insert(i);
+    for (auto &F : From) {
+        Into.push_back(std::move(F));
+        if (!Seen.insert(Into.size() - 1).second)
+            Into.pop_back();
+    }
+}
+
+// Checks a file under its other configurations for -all-configs. Of their
+// findings only those in lines that the first configuration skipped are new,
+// and each of them is added once.
+static void checkOtherConfigurations(const std::vector<CompileCommand> &Configurations,
+                                     const std::string &File, const SkippedLines &Skipped,
+                                     std::unordered_map<std::string, Statistics> &Result,
+                                     const RunConfig &Config, FileSystemCache &Cache) {
+    // Renames are only planned under the first configuration
+    RunConfig OtherConfig = Config;
+    OtherConfig.Fixes = nullptr;
+    OtherConfig.Skipped = nullptr;
+    OtherConfig.OnlySkipped = &Skipped;
+    for (size_t c = 1; c < Configurations.size(); ++c) {
+        if (Config.Control && Config.Control->shouldStop()) {
+            Result[baseName(File).str()].incomplete = true;
+            return;
+        }
+        std::unordered_map<std::string, Statistics> Other;
+        SingleCommandDatabase Database(Configurations[c]);
+        NameActionFactory Factory(Other, OtherConfig);
+        newTool(Database, {File}, Cache)->run(&Factory);
+
+        for (auto &[Name, Stats] : Other) {
+            auto &Into = Result[Name];
+            appendNew(Into.bad_names, Stats.bad_names, [](const BadName &Bad) {
+                return std::tie(Bad.file, Bad.line, Bad.name, Bad.entity);
+            });
+            appendNew(Into.mistakes, Stats.mistakes, [](const Mistake &M) {
+                return std::tie(M.file, M.line, M.name, M.wrong_word, M.ok_word);
+            });
+            Into.incomplete |= Stats.incomplete;
+        }
+    }
+}
+
+// Checks the files of a batch as one translation unit that includes them all,
+// compiled with the given command of the first one. Returns false, leaving
+// Result untouched, if the files do not compile together, e.g. because they
+// define the same static function.
+static bool checkJumbo(const CompileCommand &First, const std::vector<std::string> &Files,
+                       std::unordered_map<std::string, Statistics> &Result,
+                       const RunConfig &Config, FileSystemCache &Cache) {
+    std::vector<std::string> Members;
+    std::string Contents;
+    for (const auto &File : Files) {
+        SmallString<256> Path(File);
+        sys::fs::make_absolute(Path);
+        Contents += "#include \"" + std::string(Path) + "\"\n";
+        Members.push_back(std::string(Path));
+    }
+    SmallString<256> JumboPath = sys::path::parent_path(Members.front());
+    sys::path::append(JumboPath, "check_names_jumbo.cpp");
+
+    CompileCommand Command = First;
+    auto &Args = Command.CommandLine;
+    if (std::find(Args.begin(), Args.end(), Command.Filename) == Args.end())
+        return false;
+    std::replace(Args.begin(), Args.end(), Command.Filename, std::string(JumboPath));
+    Command.Filename = std::string(JumboPath);
+    SingleCommandDatabase Jumbo(std::move(Command));
+
+    // Nothing is counted for -summary and no finding stops the run unless
+    // the batch compiles
+    RunConfig JumboConfig = Config;
+    std::optional<SummaryCounters> Counted;
+    if (Config.Summary)
+        JumboConfig.Summary = &Counted.emplace(SummaryTop);
+    std::optional<RunControl> Control;
+    if (Config.Control)
+        JumboConfig.Control = &Control.emplace(*Config.Control);
+
+    auto Tool = newTool(Jumbo, {std::string(JumboPath)}, Cache);
+    Tool->mapVirtualFile(JumboPath, Contents);
+    // Errors only mean falling back to separate parses, which report them
+    IgnoringDiagConsumer Quiet;
+    Tool->setDiagnosticConsumer(&Quiet);
+    std::unordered_map<std::string, Statistics> Batch;
+    NameActionFactory Factory(Batch, JumboConfig, std::move(Members));
+    if (Tool->run(&Factory) != 0)
+        return false;
+
+    for (auto &[File, Stats] : Batch)
+        Result[File] = std::move(Stats);
+    if (Counted)
+        Config.Summary->merge(*Counted);
+    if (Control)
+        Control->commit();
+    return true;
+}
+
+// Summary counters of the workers of a run. Each task borrows one set for its
+// duration, so there are never more sets than threads, and they are merged
+// once all tasks are done.
+class WorkerCounters {
+public:
+    WorkerCounters(size_t Workers, size_t TopNames) {
+        for (size_t i = 0; i < Workers; ++i)
+            Counters.emplace_back(TopNames);
+        for (auto &C : Counters)
+            Free.push_back(&C);
+    }
+
+    SummaryCounters *acquire() {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        SummaryCounters *C = Free.back();
+        Free.pop_back();
+        return C;
+    }
+
+    void release(SummaryCounters *C) {
+        std::lock_guard<std::mutex> Lock(Mutex);
+        Free.push_back(C);
+    }
+
+    void mergeInto(SummaryCounters &Total) const {
+        for (const auto &C : Counters)
+            Total.merge(C);
+    }
+
+private:
+    std::mutex Mutex;
+    std::deque<SummaryCounters> Counters;
+    std::vector<SummaryCounters *> Free;
+};
+
+static const char *entityName(Entity E) {
+    switch (E) {
+    case Entity::kVariable:
+        return "variable";
+    case Entity::kField:
+        return "field";
+    case Entity::kType:
+        return "type";
+    case Entity::kConst:
+        return "const";
+    case Entity::kFunction:
+        return "function";
+    }
+    return "unknown";
+}
+
+// One tab-separated record per line:
+//   bad <directory> <entity> <rule> <count>
+//   typo <directory> <count>
+//   top <name> <count> <error>
+// followed by a line "incomplete" if some file was not fully checked.
+static void writeSummary(const NameSummary &Summary, const std::string &Path) {
+    std::error_code EC;
+    raw_fd_ostream Out(Path, EC);
+    if (EC) {
+        errs() << "check_names: cannot write summary " << Path << ": " << EC.message() << "\n";
+        return;
+    }
+    for (const auto &Count : Summary.bad_names)
+        Out << "bad\t" << Count.directory << '\t' << entityName(Count.entity) << '\t'
+            << Count.rule << '\t' << Count.count << '\n';
+    for (const auto &[Directory, Count] : Summary.typos)
+        Out << "typo\t" << Directory << '\t' << Count << '\n';
+    for (const auto &Top : Summary.top_names)
+        Out << "top\t" << Top.name << '\t' << Top.count << '\t' << Top.error << '\n';
+    if (Summary.incomplete)
+        Out << "incomplete\n";
+    closeOutput(Out, Path, "summary");
+}
+
+static std::string formatRate(const ViolationRate &Rate) {
+    std::string Result;
+    raw_string_ostream Out(Result);
+    Out << format("%.4f\t%.4f\t%.4f", Rate.rate, Rate.low, Rate.high);
+    return Result;
+}
+
+// One tab-separated record per line, with rates in violations per file
+// followed by the bounds of their 95% confidence interval:
+//   directory <directory> <files> <checked> <rate> <low> <high>
+//   entity <entity> <rate> <low> <high>
+//   typo <rate> <low> <high>
+//   total <files> <checked> <rate> <low> <high>
+// followed by a line "incomplete" if some sampled file was not fully checked.
+static void writeEstimate(const NameEstimate &Estimate, const std::string &Path) {
+    std::error_code EC;
+    raw_fd_ostream Out(Path, EC);
+    if (EC) {
+        errs() << "check_names: cannot write estimate " << Path << ": " << EC.message() << "\n";
+        return;
+    }
+    for (const auto &Directory : Estimate.directories)
+        Out << "directory\t" << Directory.directory << '\t' << Directory.files << '\t'
+            << Directory.checked << '\t' << formatRate(Directory.violations) << '\n';
+    for (const auto &E : Estimate.entities)
+        Out << "entity\t" << entityName(E.entity) << '\t' << formatRate(E.bad_names) << '\n';
+    Out << "typo\t" << formatRate(Estimate.typos) << '\n';
+    Out << "total\t" << Estimate.files << '\t' << Estimate.checked << '\t'
+        << formatRate(Estimate.violations) << '\n';
+    if (Estimate.incomplete)
+        Out << "incomplete\n";
+    closeOutput(Out, Path, "estimate");
+}
+
+// Runs a check with the options of CheckNames. If Summary is given, or with
+// -summary, violations are only counted; the returned results then just mark
+// incomplete files. If Estimate is given, or with -estimate, violation rates
+// are estimated from the checked files.
+static std::unordered_map<std::string, Statistics> runChecks(int argc, const char *argv[],
+                                                            NameSummary *Summary,
+                                                            NameEstimate *Estimate) {
+    auto ExpectedParser = CommonOptionsParser::create(argc, argv, CheckNamesCategory);
+    if (!ExpectedParser) {
+        llvm::errs() << ExpectedParser.takeError();
+        return {};
+    }
+    CommonOptionsParser &OptionsParser = ExpectedParser.get();
+    std::unordered_map<std::string, Statistics> StatsMap;
+
+    NameSummary SummaryForFile;
+    if (!Summary && !SummaryPath.empty())
+        Summary = &SummaryForFile;
+    if (Summary && (!BaselinePath.empty() || !WriteBaselinePath.empty() || !WriteStatsPath.empty())) {
+        errs() << "check_names: -summary keeps no violations for baselines or -write-stats\n";
+        return {};
+    }
+    if (Quick && Fix) {
+        errs() << "check_names: -quick finds no style violations for -fix to rename\n";
+        return {};
+    }
+    if (Summary && AllConfigs) {
+        errs() << "check_names: -all-configs cannot be combined with -summary\n";
+        return {};
+    }
+    NameEstimate EstimateForFile;
+    if (!Estimate && !EstimatePath.empty())
+        Estimate = &EstimateForFile;
+    std::optional<SampleSize> Size = parseSampleSize(Sample.empty() ? "1.0" : Sample);
+    if (!Size) {
+        errs() << "check_names: -sample takes a fraction in (0, 1] or a number of files\n";
+        return {};
+    }
+    if (Summary && (Estimate || !Sample.empty())) {
+        errs() << "check_names: -sample and -estimate need the results of every file, "
+                  "which -summary does not keep\n";
+        return {};
+    }
+
+    RunConfig Config;
+    if (!DictionaryPath.empty())
+        Config.Dict = &loadDictionary(DictionaryPath);
+    PolicySet Policies;
+    if (!NamingConfigPath.empty()) {
+        if (!Policies.loadFromFile(NamingConfigPath))
+            return {};
+        Config.Policies = &Policies;
+    }
+
+    // Loaded once and shared by the workers of -fail-fast and the final filter
+    std::optional<Baseline> Known;
+    if (!BaselinePath.empty() && !Known.emplace().load(BaselinePath))
+        Known.reset();
+
+    // With a baseline, a finding may turn out to be known, so fail-fast
+    // can only decide once a whole file is checked and filtered
+    RunControl Control;
+    if (DeadlineMs)
+        Control.setDeadline(std::chrono::milliseconds(DeadlineMs));
+    Control.setStopOnFirstFinding(FailFast && BaselinePath.empty());
+    Config.Control = &Control;
+    RenameFixes Fixes;
+    if (Fix)
+        Config.Fixes = &Fixes;
+    
+    // First, collect all source files and sort them to ensure consistent order
+    std::vector<std::string> sourceFiles = OptionsParser.getSourcePathList();
+    std::sort(sourceFiles.begin(), sourceFiles.end());
+    // The sample is drawn from the sorted list, so that it does not depend on
+    // the order of the arguments
+    std::optional<StratifiedSample> Sampled;
+    StringMap<size_t> SampleIndex;  // Index of each checked file in the sampled list
+    if (!Sample.empty() || Estimate) {
+        Sampled.emplace(sourceFiles, *Size, SampleSeed);
+        std::vector<std::string> Picked;
+        for (size_t i : Sampled->picked()) {
+            SampleIndex.try_emplace(sourceFiles[i], i);
+            Picked.push_back(sourceFiles[i]);
+        }
+        if (!Sample.empty())
+            errs() << "check_names: checking a sample of " << Picked.size() << " of "
+                   << sourceFiles.size() << " files\n";
+        sourceFiles = std::move(Picked);
+    }
+    // Under a latency budget the most recently modified files go first
+    if (FailFast || DeadlineMs)
+        sortByModificationTime(sourceFiles);
+    
+    const CompilationDatabase &Compilations = OptionsParser.getCompilations();
+
+    // A file listed with several compile commands is parsed once per
+    // configuration with -all-configs, and otherwise only once.
+    std::vector<std::vector<CompileCommand>> Configurations(sourceFiles.size());
+    size_t NumCommands = 0, NumParses = 0;
+    for (size_t i = 0; i < sourceFiles.size() && !Quick; ++i) {
+        auto Commands = Compilations.getCompileCommands(sourceFiles[i]);
+        NumCommands += Commands.size();
+        Configurations[i] = distinctConfigurations(std::move(Commands));
+        NumParses += AllConfigs ? Configurations[i].size()
+                                : std::min<size_t>(Configurations[i].size(), 1);
+    }
+
+    // Renames are only planned on translation units that compile, so -fix
+    // does not take the chance of a jumbo batch that does not.
+    auto Batches = jumboBatches(Configurations, sourceFiles, Quick || Fix ? 0 : JumboSize);
+
+    // All tools of the run read through one cache, so a header included by
+    // many translation units is stat'ed and read once.
+    FileSystemCache FileCache;
+    std::vector<std::string> MainFiles;
+    std::vector<size_t> BatchEnds;  // End of each batch in MainFiles
+    for (const auto &Batch : Batches) {
+        for (size_t i : Batch)
+            MainFiles.push_back(sourceFiles[i]);
+        BatchEnds.push_back(MainFiles.size());
+    }
+
+    // Every worker checks one batch of files at a time into the slot of its
+    // first file, and the slots are merged in the order above once all
+    // workers are done.
+    std::vector<std::unordered_map<std::string, Statistics>> Results(sourceFiles.size());
+    ThreadPoolStrategy Strategy = hardware_concurrency(Jobs);
+    ThreadPool Pool(Strategy);
+    WorkerCounters Counters(Summary ? Strategy.compute_thread_count() : 0, SummaryTop);
+    // Main files of the next batches are read while the current ones parse
+    std::optional<ReadAhead> Prefetch;
+    if (!Quick)
+        Prefetch.emplace(FileCache, std::move(MainFiles), 2 * Strategy.compute_thread_count());
+    for (size_t b = 0; b < Batches.size(); ++b) {
+        Pool.async([&, b] {
+            const auto &Batch = Batches[b];
+            if (Prefetch)
+                Prefetch->started(BatchEnds[b] - 1);
+            auto &Result = Results[Batch.front()];
+            if (Control.shouldStop()) {
+                for (size_t i : Batch)
+                    Result[baseName(sourceFiles[i]).str()].incomplete = true;
+                return;
+            }
+            RunConfig TaskConfig = Config;
+            if (Summary)
+                TaskConfig.Summary = Counters.acquire();
+            if (Quick) {
+                size_t i = Batch.front();
+                scanQuick(Result[baseName(sourceFiles[i]).str()], TaskConfig, sourceFiles[i]);
+            } else {
+                std::vector<std::string> Files;
+                for (size_t i : Batch)
+                    Files.push_back(sourceFiles[i]);
+                SkippedLines Skipped;
+                if (AllConfigs)
+                    TaskConfig.Skipped = &Skipped;
+                if (Files.size() == 1 || !checkJumbo(Configurations[Batch.front()].front(), Files,
+                                                     Result, TaskConfig, FileCache)) {
+                    Skipped.clear();
+                    for (size_t i : Batch)
+                        checkFile(Compilations, Configurations[i], sourceFiles[i], Result,
+                                  TaskConfig, FileCache);
+                }
+                if (AllConfigs) {
+                    for (size_t i : Batch)
+                        checkOtherConfigurations(Configurations[i], sourceFiles[i], Skipped,
+                                                 Result, TaskConfig, FileCache);
+                }
+            }
+            if (Summary)
+                Counters.release(TaskConfig.Summary);
+
+            if (FailFast && !BaselinePath.empty()) {
+                auto NewFindings = Result;
+                if (Known)
+                    Known->suppress(&NewFindings);
+                if (hasFindings(NewFindings))
+                    Control.stop();
+            }
+        });
+    }
+    Pool.wait();
+    if (NumParses < NumCommands)
+        errs() << "check_names: saved " << NumCommands - NumParses << " of " << NumCommands
+               << " parses by parsing each file "
+               << (AllConfigs ? "once per configuration" : "in its first configuration only")
+               << "\n";
+
+    if (Fix) {
+        auto Applied = Fixes.apply(Pool);
+        if (Applied.Conflicts)
+            errs() << "check_names: skipped " << Applied.Conflicts
+                   << " renames that overlap other renames, run -fix again to apply them\n";
+        if (Applied.Clashes)
+            errs() << "check_names: skipped " << Applied.Clashes
+                   << " renames to names that are already declared\n";
+    }
+
+    if (Estimate) {
+        // Every file has its own results in the slot of its batch, even if
+        // files of other batches have the same name
+        static const Statistics Missing = [] {
+            Statistics Stats;
+            Stats.incomplete = true;
+            return Stats;
+        }();
+        for (const auto &Batch : Batches) {
+            for (size_t i : Batch) {
+                const auto &Slot = Results[Batch.front()];
+                auto It = Slot.find(baseName(sourceFiles[i]).str());
+                Sampled->addResult(SampleIndex[sourceFiles[i]],
+                                   It != Slot.end() ? It->second : Missing);
+            }
+        }
+        *Estimate = Sampled->estimate();
+        if (!EstimatePath.empty())
+            writeEstimate(*Estimate, EstimatePath);
+    }
+
+    for (auto &Result : Results) {
+        for (auto &[File, Stats] : Result) {
+            auto &Into = StatsMap[File];
+            std::move(Stats.bad_names.begin(), Stats.bad_names.end(),
+                      std::back_inserter(Into.bad_names));
+            std::move(Stats.mistakes.begin(), Stats.mistakes.end(),
+                      std::back_inserter(Into.mistakes));
+            Into.incomplete |= Stats.incomplete;
+        }
+    }
+
+    if (!WriteBaselinePath.empty())
+        WriteBaseline(StatsMap, WriteBaselinePath);
+    if (Known)
+        Known->suppress(&StatsMap);
+    if (!WriteStatsPath.empty())
+        WriteStatistics(StatsMap, WriteStatsPath);
+
+    if (Summary) {
+        SummaryCounters Total(SummaryTop);
+        Counters.mergeInto(Total);
+        Total.exportTo(*Summary);
+        Summary->incomplete = std::any_of(StatsMap.begin(), StatsMap.end(), [](const auto &Entry) {
+            return Entry.second.incomplete;
+        });
+        if (!SummaryPath.empty())
+            writeSummary(*Summary, SummaryPath);
+    }
+    return StatsMap;
+}
+
+std::unordered_map<std::string, Statistics> CheckNames(int argc, const char* argv[]) {
+    return runChecks(argc, argv, nullptr, nullptr);
+}
+
+NameSummary SummarizeNames(int argc, const char* argv[]) {
+    NameSummary Summary;
+    runChecks(argc, argv, &Summary, nullptr);
+    return Summary;
+}
+
+NameEstimate EstimateNames(int argc, const char* argv[]) {
+    NameEstimate Estimate;
+    runChecks(argc, argv, nullptr, &Estimate);
+    return Estimate;
+}
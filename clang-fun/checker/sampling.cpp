@@ -0,0 +1,219 @@
+#include "sampling.h"
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/Twine.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/xxhash.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+
+using namespace llvm;
+
+namespace {
+
+constexpr double kZ95 = 1.959964;  // Two-sided 95% quantile of the normal distribution
+constexpr double kUnknown = std::numeric_limits<double>::infinity();
+
+double sumOf(const std::array<double, kNumEntities + 1> &Counts,
+             const std::vector<size_t> &Indices) {
+    double Sum = 0;
+    for (size_t i : Indices)
+        Sum += Counts[i];
+    return Sum;
+}
+
+ViolationRate interval(double Mean, double Variance) {
+    if (std::isinf(Variance))
+        return {Mean, 0, kUnknown};
+    double HalfWidth = kZ95 * std::sqrt(Variance);
+    return {Mean, std::max(0.0, Mean - HalfWidth), Mean + HalfWidth};
+}
+
+} // namespace
+
+std::optional<SampleSize> parseSampleSize(StringRef Value) {
+    SampleSize Size;
+    if (Value.contains('.')) {
+        if (Value.getAsDouble(Size.Fraction) || !(Size.Fraction > 0 && Size.Fraction <= 1))
+            return std::nullopt;
+        return Size;
+    }
+    if (Value.getAsInteger(10, Size.Count) || Size.Count == 0)
+        return std::nullopt;
+    return Size;
+}
+
+StratifiedSample::StratifiedSample(const std::vector<std::string> &Files, const SampleSize &Size,
+                                   uint64_t Seed) {
+    std::map<std::string, std::vector<size_t>> ByDirectory;
+    for (size_t i = 0; i < Files.size(); ++i) {
+        SmallString<256> Path(Files[i]);
+        sys::fs::make_absolute(Path);
+        sys::path::remove_dots(Path);
+        ByDirectory[std::string(sys::path::parent_path(Path))].push_back(i);
+    }
+    StratumOf.resize(Files.size());
+    for (const auto &[Directory, Members] : ByDirectory) {
+        for (size_t i : Members)
+            StratumOf[i] = Strata.size();
+        Strata.push_back({Directory, Members.size()});
+    }
+
+    // Proportional allocation with at least one file per directory, and the
+    // rest by largest remainder. The sample never exceeds the target: if the
+    // floors and the minimum of one overshoot it, the directories furthest
+    // above their quota give files back, and if there are more directories
+    // than files to pick, directories are picked by hash and get one each.
+    size_t Total = Files.size();
+    size_t Target = Size.Count ? Size.Count : static_cast<size_t>(std::ceil(Size.Fraction * Total));
+    Target = std::min(Target, Total);
+    if (Target < Strata.size()) {
+        std::vector<std::pair<uint64_t, size_t>> Ranked;
+        for (size_t h = 0; h < Strata.size(); ++h)
+            Ranked.emplace_back(xxHash64((Twine(Seed) + ":" + Strata[h].Directory).str()), h);
+        std::partial_sort(Ranked.begin(), Ranked.begin() + Target, Ranked.end());
+        for (size_t j = 0; j < Target; ++j)
+            Strata[Ranked[j].second].Picked = 1;
+    } else {
+        std::vector<double> Quotas;
+        size_t Assigned = 0;
+        for (auto &S : Strata) {
+            Quotas.push_back(static_cast<double>(Target) * S.Files / Total);
+            S.Picked = std::min(S.Files, std::max<size_t>(1, static_cast<size_t>(Quotas.back())));
+            Assigned += S.Picked;
+        }
+        while (Assigned > Target) {
+            size_t Best = Strata.size();
+            for (size_t h = 0; h < Strata.size(); ++h) {
+                if (Strata[h].Picked > 1 &&
+                    (Best == Strata.size() ||
+                     Strata[h].Picked - Quotas[h] > Strata[Best].Picked - Quotas[Best]))
+                    Best = h;
+            }
+            --Strata[Best].Picked;
+            --Assigned;
+        }
+        while (Assigned < Target) {
+            size_t Best = Strata.size();
+            for (size_t h = 0; h < Strata.size(); ++h) {
+                if (Strata[h].Picked < Strata[h].Files &&
+                    (Best == Strata.size() ||
+                     Quotas[h] - Strata[h].Picked > Quotas[Best] - Strata[Best].Picked))
+                    Best = h;
+            }
+            ++Strata[Best].Picked;
+            ++Assigned;
+        }
+    }
+
+    size_t h = 0;
+    for (const auto &[Directory, Members] : ByDirectory) {
+        std::vector<std::pair<uint64_t, size_t>> Ranked;
+        for (size_t i : Members)
+            Ranked.emplace_back(xxHash64((Twine(Seed) + ":" + Files[i]).str()), i);
+        size_t Count = Strata[h++].Picked;
+        std::partial_sort(Ranked.begin(), Ranked.begin() + Count, Ranked.end());
+        for (size_t j = 0; j < Count; ++j)
+            Picked.push_back(Ranked[j].second);
+    }
+    std::sort(Picked.begin(), Picked.end());
+}
+
+void StratifiedSample::addResult(size_t File, const Statistics &Stats) {
+    if (Stats.incomplete) {
+        Incomplete = true;
+        return;
+    }
+    Counts C{};
+    for (const auto &Bad : Stats.bad_names)
+        ++C[static_cast<size_t>(Bad.entity)];
+    C[kTypos] = Stats.mistakes.size();
+    Strata[StratumOf[File]].Checked.push_back(C);
+}
+
+double StratifiedSample::pooledVariance(const std::vector<size_t> &Indices) const {
+    double SquaredDeviations = 0;
+    size_t DegreesOfFreedom = 0;
+    for (const auto &S : Strata) {
+        if (S.Checked.size() < 2)
+            continue;
+        double Mean = 0;
+        for (const auto &C : S.Checked)
+            Mean += sumOf(C, Indices);
+        Mean /= S.Checked.size();
+        for (const auto &C : S.Checked)
+            SquaredDeviations += (sumOf(C, Indices) - Mean) * (sumOf(C, Indices) - Mean);
+        DegreesOfFreedom += S.Checked.size() - 1;
+    }
+    return DegreesOfFreedom ? SquaredDeviations / DegreesOfFreedom : kUnknown;
+}
+
+std::pair<double, double> StratifiedSample::meanAndVariance(const Stratum &S,
+                                                            const std::vector<size_t> &Indices,
+                                                            double PooledVariance) const {
+    size_t N = S.Checked.size();
+    double Mean = 0;
+    for (const auto &C : S.Checked)
+        Mean += sumOf(C, Indices);
+    Mean /= N;
+    if (N == S.Files)
+        return {Mean, 0};
+
+    double Variance = PooledVariance;
+    if (N >= 2) {
+        Variance = 0;
+        for (const auto &C : S.Checked)
+            Variance += (sumOf(C, Indices) - Mean) * (sumOf(C, Indices) - Mean);
+        Variance /= N - 1;
+    }
+    return {Mean, (1 - static_cast<double>(N) / S.Files) * Variance / N};
+}
+
+ViolationRate StratifiedSample::estimateRate(const std::vector<size_t> &Indices) const {
+    double Pooled = pooledVariance(Indices);
+    size_t Covered = 0;
+    for (const auto &S : Strata)
+        Covered += S.Checked.empty() ? 0 : S.Files;
+    if (!Covered)
+        return {0, 0, kUnknown};
+
+    double Mean = 0, Variance = 0;
+    for (const auto &S : Strata) {
+        if (S.Checked.empty())
+            continue;
+        double Weight = static_cast<double>(S.Files) / Covered;
+        auto [StratumMean, StratumVariance] = meanAndVariance(S, Indices, Pooled);
+        Mean += Weight * StratumMean;
+        Variance += Weight * Weight * StratumVariance;
+    }
+    return interval(Mean, Variance);
+}
+
+NameEstimate StratifiedSample::estimate() const {
+    NameEstimate Result;
+    std::vector<size_t> All(kNumCounts);
+    std::iota(All.begin(), All.end(), 0);
+    double Pooled = pooledVariance(All);
+
+    Result.incomplete = Incomplete;
+    for (const auto &S : Strata) {
+        Result.files += S.Files;
+        Result.checked += S.Checked.size();
+        ViolationRate Rate{0, 0, kUnknown};
+        if (!S.Checked.empty()) {
+            auto [Mean, Variance] = meanAndVariance(S, All, Pooled);
+            Rate = interval(Mean, Variance);
+        } else {
+            Result.incomplete = true;
+        }
+        Result.directories.push_back({S.Directory, S.Files, S.Checked.size(), Rate});
+    }
+    for (size_t E = 0; E < kNumEntities; ++E)
+        Result.entities.push_back({static_cast<Entity>(E), estimateRate({E})});
+    Result.typos = estimateRate({kTypos});
+    Result.violations = estimateRate(All);
+    return Result;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../check_names.h"
+#include "name_summary.h"
+#include <llvm/ADT/StringRef.h>
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Argument of -sample: a fraction of the files if it has a decimal point,
+// otherwise a number of files.
+struct SampleSize {
+    double Fraction = 1;
+    size_t Count = 0;  // Used if not 0
+};
+
+std::optional<SampleSize> parseSampleSize(llvm::StringRef Value);
+
+// Sample of translation units stratified by directory, and the estimates of
+// violation rates from their results. The sample has exactly the requested
+// size (at most all files). Every directory gets at least one file and
+// otherwise a share proportional to its size; if there are fewer files to
+// pick than directories, the directories with the smallest hash of seed and
+// path get one file each and the others none. Within a directory, the
+// files with the smallest hash of seed and path are picked, so a sample is
+// the same on every run and mostly stays the same as files come and go.
+class StratifiedSample {
+public:
+    StratifiedSample(const std::vector<std::string> &Files, const SampleSize &Size,
+                     uint64_t Seed);
+
+    // Indices of the picked files, ascending
+    const std::vector<size_t> &picked() const { return Picked; }
+
+    // Takes the results of a picked file. Incomplete files are left out of
+    // the estimates.
+    void addResult(size_t File, const Statistics &Stats);
+
+    // Stratified means with normal confidence intervals and finite population
+    // correction. Directories with one checked file borrow the pooled
+    // variance of the others; directories without any are left out and
+    // make the estimate incomplete.
+    NameEstimate estimate() const;
+
+private:
+    static constexpr size_t kTypos = kNumEntities;  // Counts by entity, then typos
+    static constexpr size_t kNumCounts = kNumEntities + 1;
+    using Counts = std::array<double, kNumCounts>;
+
+    struct Stratum {
+        std::string Directory;
+        size_t Files = 0;
+        size_t Picked = 0;
+        std::vector<Counts> Checked;  // Counts of the fully checked picked files
+    };
+
+    // Rates of the sum of the counts at Indices. For one directory the
+    // result is its mean and the variance of that mean.
+    ViolationRate estimateRate(const std::vector<size_t> &Indices) const;
+    std::pair<double, double> meanAndVariance(const Stratum &S, const std::vector<size_t> &Indices,
+                                              double PooledVariance) const;
+    double pooledVariance(const std::vector<size_t> &Indices) const;
+
+    std::vector<Stratum> Strata;     // Sorted by directory
+    std::vector<size_t> StratumOf;   // By file
+    std::vector<size_t> Picked;
+    bool Incomplete = false;
+};
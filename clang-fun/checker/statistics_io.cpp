@@ -0,0 +1,232 @@
+#include "../check_names.h"
+#include "output_file.h"
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace llvm;
+
+// Results file layout (native byte order, every field 4-byte aligned):
+//   StatsHeader
+//   FileRecord    Files[NumFiles]          sorted by file name
+//   BadNameRecord BadNames[NumBadNames]    grouped by file, in reported order
+//   MistakeRecord Mistakes[NumMistakes]    grouped by file, in reported order
+//   char          Strings[StringsSize]     NUL-terminated, deduplicated
+//
+// Strings are referenced by their offset in Strings. Records have a fixed
+// width, so a reader can index them straight from a memory mapping.
+
+static constexpr char StatsMagic[4] = {'C', 'N', 'S', 'T'};
+static constexpr uint32_t StatsVersion = 1;
+
+struct StatsHeader {
+    char Magic[4];
+    uint32_t Version;
+    uint32_t NumFiles;
+    uint32_t NumBadNames;
+    uint32_t NumMistakes;
+    uint32_t StringsSize;
+};
+
+struct FileRecord {
+    uint32_t Name;
+    uint32_t FirstBadName;
+    uint32_t NumBadNames;
+    uint32_t FirstMistake;
+    uint32_t NumMistakes;
+    uint32_t Incomplete;
+};
+
+struct BadNameRecord {
+    uint32_t File;
+    uint32_t Name;
+    uint32_t Entity;
+    uint32_t Line;
+};
+
+struct MistakeRecord {
+    uint32_t File;
+    uint32_t Name;
+    uint32_t WrongWord;
+    uint32_t OkWord;
+    uint32_t Line;
+};
+
+namespace {
+
+class StringTable {
+public:
+    uint32_t add(StringRef S) {
+        auto [It, Inserted] = Offsets.try_emplace(S, Data.size());
+        if (Inserted) {
+            Data.append(S.begin(), S.end());
+            Data.push_back('\0');
+        }
+        return It->second;
+    }
+
+    const std::string &data() const { return Data; }
+
+private:
+    StringMap<uint32_t> Offsets;
+    std::string Data;
+};
+
+template <class T>
+void writeArray(raw_ostream &Out, const std::vector<T> &Items) {
+    Out.write(reinterpret_cast<const char *>(Items.data()), Items.size() * sizeof(T));
+}
+
+template <class T>
+const T *arrayAt(const char *&Cursor, uint32_t Count) {
+    auto *Items = reinterpret_cast<const T *>(Cursor);
+    Cursor += static_cast<size_t>(Count) * sizeof(T);
+    return Items;
+}
+
+} // namespace
+
+void WriteStatistics(const std::unordered_map<std::string, Statistics>& stats,
+                     const std::string& path) {
+    std::vector<const std::pair<const std::string, Statistics> *> Sorted;
+    for (const auto &Entry : stats)
+        Sorted.push_back(&Entry);
+    std::sort(Sorted.begin(), Sorted.end(),
+              [](const auto *A, const auto *B) { return A->first < B->first; });
+
+    StringTable Strings;
+    std::vector<FileRecord> Files;
+    std::vector<BadNameRecord> BadNames;
+    std::vector<MistakeRecord> Mistakes;
+    for (const auto *Entry : Sorted) {
+        const Statistics &Stats = Entry->second;
+        Files.push_back({Strings.add(Entry->first), static_cast<uint32_t>(BadNames.size()),
+                         static_cast<uint32_t>(Stats.bad_names.size()),
+                         static_cast<uint32_t>(Mistakes.size()),
+                         static_cast<uint32_t>(Stats.mistakes.size()), Stats.incomplete});
+        for (const auto &Bad : Stats.bad_names)
+            BadNames.push_back({Strings.add(Bad.file), Strings.add(Bad.name),
+                                static_cast<uint32_t>(Bad.entity),
+                                static_cast<uint32_t>(Bad.line)});
+        for (const auto &M : Stats.mistakes)
+            Mistakes.push_back({Strings.add(M.file), Strings.add(M.name), Strings.add(M.wrong_word),
+                                Strings.add(M.ok_word), static_cast<uint32_t>(M.line)});
+    }
+
+    std::error_code EC;
+    raw_fd_ostream Out(path, EC);
+    if (EC) {
+        errs() << "check_names: cannot write results " << path << ": " << EC.message() << "\n";
+        return;
+    }
+    StatsHeader Header;
+    std::memcpy(Header.Magic, StatsMagic, sizeof(StatsMagic));
+    Header.Version = StatsVersion;
+    Header.NumFiles = Files.size();
+    Header.NumBadNames = BadNames.size();
+    Header.NumMistakes = Mistakes.size();
+    Header.StringsSize = Strings.data().size();
+    Out.write(reinterpret_cast<const char *>(&Header), sizeof(Header));
+    writeArray(Out, Files);
+    writeArray(Out, BadNames);
+    writeArray(Out, Mistakes);
+    Out << Strings.data();
+    closeOutput(Out, path, "results");
+}
+
+bool ReadStatistics(const std::string& path,
+                    std::unordered_map<std::string, Statistics>* stats) {
+    auto BufferOrErr = MemoryBuffer::getFile(path, /*IsText=*/false,
+                                             /*RequiresNullTerminator=*/false);
+    if (!BufferOrErr) {
+        errs() << "check_names: cannot read results " << path << ": "
+               << BufferOrErr.getError().message() << "\n";
+        return false;
+    }
+    const MemoryBuffer &Buffer = **BufferOrErr;
+
+    StatsHeader Header;
+    if (Buffer.getBufferSize() < sizeof(Header)) {
+        errs() << "check_names: truncated results " << path << "\n";
+        return false;
+    }
+    std::memcpy(&Header, Buffer.getBufferStart(), sizeof(Header));
+    uint64_t ExpectedSize = sizeof(Header) + uint64_t(Header.NumFiles) * sizeof(FileRecord) +
+                            uint64_t(Header.NumBadNames) * sizeof(BadNameRecord) +
+                            uint64_t(Header.NumMistakes) * sizeof(MistakeRecord) +
+                            Header.StringsSize;
+    if (std::memcmp(Header.Magic, StatsMagic, sizeof(StatsMagic)) != 0 ||
+        Header.Version != StatsVersion || Buffer.getBufferSize() != ExpectedSize ||
+        (Header.StringsSize && Buffer.getBufferEnd()[-1] != '\0')) {
+        errs() << "check_names: invalid results " << path << "\n";
+        return false;
+    }
+
+    const char *Cursor = Buffer.getBufferStart() + sizeof(Header);
+    const auto *Files = arrayAt<FileRecord>(Cursor, Header.NumFiles);
+    const auto *BadNames = arrayAt<BadNameRecord>(Cursor, Header.NumBadNames);
+    const auto *Mistakes = arrayAt<MistakeRecord>(Cursor, Header.NumMistakes);
+    const char *Strings = Cursor;
+    auto String = [&](uint32_t Offset) -> std::string {
+        return Offset < Header.StringsSize ? Strings + Offset : "";
+    };
+
+    for (const FileRecord *File = Files; File != Files + Header.NumFiles; ++File) {
+        if (uint64_t(File->FirstBadName) + File->NumBadNames > Header.NumBadNames ||
+            uint64_t(File->FirstMistake) + File->NumMistakes > Header.NumMistakes) {
+            errs() << "check_names: invalid results " << path << "\n";
+            return false;
+        }
+        Statistics &Stats = (*stats)[String(File->Name)];
+        Stats.incomplete |= File->Incomplete != 0;
+        for (uint32_t i = 0; i < File->NumBadNames; ++i) {
+            const BadNameRecord &Bad = BadNames[File->FirstBadName + i];
+            Stats.bad_names.push_back({String(Bad.File), String(Bad.Name),
+                                       static_cast<Entity>(Bad.Entity), Bad.Line});
+        }
+        for (uint32_t i = 0; i < File->NumMistakes; ++i) {
+            const MistakeRecord &M = Mistakes[File->FirstMistake + i];
+            Stats.mistakes.push_back({String(M.File), String(M.Name), String(M.WrongWord),
+                                      String(M.OkWord), M.Line});
+        }
+    }
+    return true;
+}
+
+// Appends the records of From that Into does not have yet.
+template <class T>
+static void appendMissing(std::vector<T> &Into, std::vector<T> &From) {
+    size_t Known = Into.size();
+    for (auto &Record : From) {
+        if (std::find(Into.begin(), Into.begin() + Known, Record) == Into.begin() + Known)
+            Into.push_back(std::move(Record));
+    }
+}
+
+bool MergeStatistics(const std::vector<std::string>& paths,
+                     std::unordered_map<std::string, Statistics>* stats) {
+    std::vector<std::string> Sorted = paths;
+    std::sort(Sorted.begin(), Sorted.end());
+    for (const auto &Path : Sorted) {
+        std::unordered_map<std::string, Statistics> Sidecar;
+        if (!ReadStatistics(Path, &Sidecar))
+            return false;
+        for (auto &[File, Stats] : Sidecar) {
+            auto [It, Inserted] = stats->try_emplace(File, std::move(Stats));
+            if (Inserted || It->second == Stats)
+                continue;
+            // The same file compiled again, e.g. with and without -fPIC
+            It->second.incomplete |= Stats.incomplete;
+            appendMissing(It->second.bad_names, Stats.bad_names);
+            appendMissing(It->second.mistakes, Stats.mistakes);
+        }
+    }
+    return true;
+}
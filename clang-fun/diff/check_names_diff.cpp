@@ -0,0 +1,145 @@
+#include "../check_names.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+// Compares two results files written with -write-stats and prints
+//   + file:line: ...            violations only in the new run
+//   - file:line: ...            violations only in the old run
+//   ~ file:old -> new: ...      violations that moved to another line
+// followed by a summary. Exits with 1 if anything was added, 2 on errors.
+
+namespace {
+
+const char *entityName(Entity E) {
+    switch (E) {
+    case Entity::kVariable:
+        return "variable";
+    case Entity::kField:
+        return "field";
+    case Entity::kType:
+        return "type";
+    case Entity::kConst:
+        return "const";
+    case Entity::kFunction:
+        return "function";
+    }
+    return "unknown";
+}
+
+// One violation, reduced to what identifies it across runs plus its line.
+struct Finding {
+    std::string_view File;
+    std::string_view Name;
+    std::string_view Detail;  // Entity for bad names, wrong word for typos
+    std::string_view Suggestion;
+    bool IsTypo = false;
+    size_t Line = 0;
+
+    auto identity() const { return std::tie(IsTypo, File, Name, Detail); }
+    auto key() const { return std::tie(IsTypo, File, Name, Detail, Line); }
+};
+
+std::vector<Finding> sortedFindings(const Statistics &Stats) {
+    std::vector<Finding> Findings;
+    Findings.reserve(Stats.bad_names.size() + Stats.mistakes.size());
+    for (const auto &Bad : Stats.bad_names)
+        Findings.push_back({Bad.file, Bad.name, entityName(Bad.entity), {}, false, Bad.line});
+    for (const auto &M : Stats.mistakes)
+        Findings.push_back({M.file, M.name, M.wrong_word, M.ok_word, true, M.line});
+    std::sort(Findings.begin(), Findings.end(),
+              [](const Finding &A, const Finding &B) { return A.key() < B.key(); });
+    return Findings;
+}
+
+void printFinding(char Change, const Finding &F, const Finding *Moved = nullptr) {
+    std::string Where = std::string(F.File) + ":" + std::to_string(F.Line);
+    if (Moved)
+        Where = std::string(F.File) + ":" + std::to_string(Moved->Line) + " -> " +
+                std::to_string(F.Line);
+    if (F.IsTypo)
+        std::printf("%c %s: typo %.*s -> %.*s in %.*s\n", Change, Where.c_str(),
+                    int(F.Detail.size()), F.Detail.data(), int(F.Suggestion.size()),
+                    F.Suggestion.data(), int(F.Name.size()), F.Name.data());
+    else
+        std::printf("%c %s: %.*s %.*s\n", Change, Where.c_str(), int(F.Detail.size()),
+                    F.Detail.data(), int(F.Name.size()), F.Name.data());
+}
+
+struct Counts {
+    size_t Added = 0;
+    size_t Removed = 0;
+    size_t Moved = 0;
+};
+
+// Both sides are sorted by identity and line, so one pass pairs up the
+// occurrences of each identity in line order.
+void diffFindings(const std::vector<Finding> &Old, const std::vector<Finding> &New,
+                  Counts &Total) {
+    size_t i = 0, j = 0;
+    while (i < Old.size() || j < New.size()) {
+        if (j == New.size() || (i < Old.size() && Old[i].identity() < New[j].identity())) {
+            printFinding('-', Old[i++]);
+            ++Total.Removed;
+        } else if (i == Old.size() || New[j].identity() < Old[i].identity()) {
+            printFinding('+', New[j++]);
+            ++Total.Added;
+        } else {
+            if (Old[i].Line != New[j].Line) {
+                printFinding('~', New[j], &Old[i]);
+                ++Total.Moved;
+            }
+            ++i;
+            ++j;
+        }
+    }
+}
+
+std::vector<const std::string *> sortedFiles(
+    const std::unordered_map<std::string, Statistics> &Results) {
+    std::vector<const std::string *> Files;
+    for (const auto &Entry : Results)
+        Files.push_back(&Entry.first);
+    std::sort(Files.begin(), Files.end(),
+              [](const std::string *A, const std::string *B) { return *A < *B; });
+    return Files;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: %s <old results> <new results>\n", argv[0]);
+        return 2;
+    }
+    std::unordered_map<std::string, Statistics> Old, New;
+    if (!ReadStatistics(argv[1], &Old) || !ReadStatistics(argv[2], &New))
+        return 2;
+
+    static const Statistics Empty;
+    auto OldFiles = sortedFiles(Old);
+    auto NewFiles = sortedFiles(New);
+    Counts Total;
+    size_t i = 0, j = 0;
+    while (i < OldFiles.size() || j < NewFiles.size()) {
+        const Statistics *OldStats = &Empty;
+        const Statistics *NewStats = &Empty;
+        if (j == NewFiles.size() || (i < OldFiles.size() && *OldFiles[i] < *NewFiles[j])) {
+            OldStats = &Old[*OldFiles[i++]];
+        } else if (i == OldFiles.size() || *NewFiles[j] < *OldFiles[i]) {
+            NewStats = &New[*NewFiles[j++]];
+        } else {
+            OldStats = &Old[*OldFiles[i++]];
+            NewStats = &New[*NewFiles[j++]];
+        }
+        diffFindings(sortedFindings(*OldStats), sortedFindings(*NewStats), Total);
+    }
+
+    std::printf("%zu added, %zu removed, %zu moved\n", Total.Added, Total.Removed, Total.Moved);
+    return Total.Added ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#include "../check_names.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+// Combines the sidecar files written by the compiler plugin into one results
+// file, as written by -write-stats. Arguments are sidecar files or build
+// directories, which are searched for *.names files. Exits with 2 on errors.
+
+namespace {
+
+bool collectSidecars(const std::filesystem::path &Path, std::vector<std::string> &Sidecars) {
+    std::error_code EC;
+    if (!std::filesystem::is_directory(Path, EC)) {
+        Sidecars.push_back(Path.string());
+        return true;
+    }
+    for (std::filesystem::recursive_directory_iterator It(Path, EC), End; !EC && It != End;
+         It.increment(EC)) {
+        if (It->is_regular_file() && It->path().extension() == ".names")
+            Sidecars.push_back(It->path().string());
+    }
+    if (EC) {
+        std::fprintf(stderr, "check_names: cannot read %s: %s\n", Path.c_str(),
+                     EC.message().c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s <merged results> <sidecar or directory>...\n", argv[0]);
+        return 2;
+    }
+    std::vector<std::string> Sidecars;
+    for (int i = 2; i < argc; ++i) {
+        if (!collectSidecars(argv[i], Sidecars))
+            return 2;
+    }
+
+    std::unordered_map<std::string, Statistics> Merged;
+    if (!MergeStatistics(Sidecars, &Merged))
+        return 2;
+    WriteStatistics(Merged, argv[1]);
+    std::printf("%zu sidecars, %zu files\n", Sidecars.size(), Merged.size());
+    return 0;
+}
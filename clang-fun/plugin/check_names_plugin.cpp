@@ -0,0 +1,118 @@
+#include "../check_names.h"
+#include "../checker/name_checker.h"
+#include "../checker/naming_policy.h"
+#include <clang/AST/ASTConsumer.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Frontend/FrontendPluginRegistry.h>
+#include <llvm/Support/raw_ostream.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace clang;
+using namespace llvm;
+
+// Runs the checks as part of a normal compilation, on the AST the compiler
+// builds anyway:
+//   clang++ -fplugin=libcheck_names_plugin.so
+//           -fplugin-arg-check_names-dict=<dictionary>
+//           -fplugin-arg-check_names-naming-config=<config>
+//           -fplugin-arg-check_names-out=<sidecar>
+// The results of the translation unit are written in the format of
+// -write-stats, keyed by the name of the main file, to the sidecar file
+// (by default the output file or else the source file plus ".names").
+// MergeStatistics or check_names_merge combine the sidecars of a build.
+
+namespace {
+
+struct PluginOptions {
+    std::string DictPath;
+    std::string NamingConfigPath;
+    std::string OutPath;
+};
+
+// Owns everything the checks need, since the compiler drops the plugin action
+// right after creating its consumer.
+class SidecarConsumer : public ASTConsumer {
+public:
+    SidecarConsumer(ASTContext &Context, std::unique_ptr<PolicySet> Policies,
+                    const PluginOptions &Options, std::string MainFile)
+        : Policies(std::move(Policies)), OutPath(Options.OutPath),
+          MainFile(std::move(MainFile)) {
+        if (!Options.DictPath.empty())
+            Config.Dict = &loadDictionary(Options.DictPath);
+        if (this->Policies)
+            Config.Policies = this->Policies.get();
+        Checks = createNameConsumer(Context, Stats, Config);
+    }
+
+    void HandleTranslationUnit(ASTContext &Context) override {
+        // A translation unit that does not compile gets an empty sidecar
+        // marked incomplete, which replaces the one of an earlier build
+        if (Context.getDiagnostics().hasErrorOccurred()) {
+            Statistics Broken;
+            Broken.incomplete = true;
+            WriteStatistics({{MainFile, std::move(Broken)}}, OutPath);
+            return;
+        }
+        Checks->HandleTranslationUnit(Context);
+        WriteStatistics({{MainFile, std::move(Stats)}}, OutPath);
+    }
+
+private:
+    std::unique_ptr<PolicySet> Policies;
+    RunConfig Config;
+    Statistics Stats;
+    std::unique_ptr<ASTConsumer> Checks;
+    std::string OutPath;
+    std::string MainFile;
+};
+
+class CheckNamesPlugin : public PluginASTAction {
+protected:
+    std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &Compiler,
+                                                   StringRef InFile) override {
+        std::unique_ptr<PolicySet> Policies;
+        if (!Options.NamingConfigPath.empty()) {
+            Policies = std::make_unique<PolicySet>();
+            if (!Policies->loadFromFile(Options.NamingConfigPath))
+                return std::make_unique<ASTConsumer>();
+        }
+        PluginOptions Resolved = Options;
+        if (Resolved.OutPath.empty()) {
+            const std::string &Output = Compiler.getFrontendOpts().OutputFile;
+            Resolved.OutPath = (Output.empty() || Output == "-" ? InFile.str() : Output) + ".names";
+        }
+        return std::make_unique<SidecarConsumer>(Compiler.getASTContext(), std::move(Policies),
+                                                 Resolved, baseName(InFile).str());
+    }
+
+    bool ParseArgs(const CompilerInstance &Compiler,
+                   const std::vector<std::string> &Args) override {
+        for (StringRef Arg : Args) {
+            auto [Key, Value] = Arg.split('=');
+            if (Key == "dict") {
+                Options.DictPath = Value.str();
+            } else if (Key == "naming-config") {
+                Options.NamingConfigPath = Value.str();
+            } else if (Key == "out") {
+                Options.OutPath = Value.str();
+            } else {
+                errs() << "check_names: unknown plugin argument " << Arg << "\n";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ActionType getActionType() override { return AddAfterMainAction; }
+
+private:
+    PluginOptions Options;
+};
+
+} // namespace
+
+static FrontendPluginRegistry::Add<CheckNamesPlugin> X("check_names",
+                                                       "check identifier names and typos");
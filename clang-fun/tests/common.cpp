@@ -5,8 +5,13 @@
 #include <filesystem>
 #include <fstream>
 #include <optional>
+#include <algorithm>
+#include <system_error>
+#include <tuple>
 #include <vector>
 
+#include <unistd.h>
+
 #include <catch2/catch_test_macros.hpp>
 
 std::unordered_map<std::string, Statistics> ReadExpected(const std::filesystem::path& path) {
@@ -17,7 +22,7 @@ std::unordered_map<std::string, Statistics> ReadExpected(const std::filesystem::
     size_t n;
     for (in >> n; n; --n) {
         in >> file;
-        auto& [bad_names, mistakes] = map.emplace(file, Statistics{}).first->second;
+        [[maybe_unused]] auto& [bad_names, mistakes, incomplete] = map.emplace(file, Statistics{}).first->second;
 
         size_t k;
         for (in >> k; k; --k) {
@@ -42,7 +47,7 @@ void WriteResult(const std::unordered_map<std::string, Statistics>& map,
     out << map.size() << '\n';
     for (const auto& [file, stats] : map) {
         out << file << '\n';
-        const auto& [bad_names, mistakes] = stats;
+        [[maybe_unused]] const auto& [bad_names, mistakes, incomplete] = stats;
 
         out << bad_names.size() << '\n';
         for (const auto& bad_name : bad_names) {
@@ -85,3 +90,46 @@ void CheckDir(const std::filesystem::path& dir, const std::optional<std::filesys
     auto expected = ReadExpected(dir / "expected.txt");
     CHECK(result == expected);
 }
+
+Statistics SortedFindings(Statistics stats) {
+    auto key = [](const auto& x) { return std::tie(x.file, x.line, x.name); };
+    std::stable_sort(stats.bad_names.begin(), stats.bad_names.end(),
+                     [&](const auto& a, const auto& b) { return key(a) < key(b); });
+    std::stable_sort(stats.mistakes.begin(), stats.mistakes.end(),
+                     [&](const auto& a, const auto& b) { return key(a) < key(b); });
+    return stats;
+}
+
+TempProject::TempProject(const std::string& name)
+    : root_{std::filesystem::temp_directory_path() / (name + "_" + std::to_string(getpid()))} {
+    std::filesystem::remove_all(root_);
+    std::filesystem::create_directories(root_);
+}
+
+TempProject::~TempProject() {
+    std::error_code error;
+    std::filesystem::remove_all(root_, error);
+}
+
+std::string TempProject::Write(const std::string& name, const std::string& contents) const {
+    auto path = root_ / name;
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream{path} << contents;
+    return path.string();
+}
+
+void TempProject::AddCommand(const std::string& name, const std::string& flags) {
+    commands_.emplace_back(name, flags);
+}
+
+void TempProject::WriteCommands() const {
+    std::ofstream out{root_ / "compile_commands.json"};
+    out << "[";
+    for (size_t i = 0; i < commands_.size(); ++i) {
+        const auto& [name, flags] = commands_[i];
+        out << (i ? "," : "") << "\n{\"directory\": \"" << root_.string()
+            << "\", \"command\": \"clang++ " << flags << " -c " << name << " -o " << name
+            << ".o\", \"file\": \"" << name << "\"}";
+    }
+    out << "]\n";
+}
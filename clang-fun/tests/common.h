@@ -6,6 +6,7 @@
 #include <string>
 #include <filesystem>
 #include <optional>
+#include <utility>
 #include <vector>
 
 std::unordered_map<std::string, Statistics> ReadExpected(const std::filesystem::path& path);
@@ -17,3 +18,33 @@ std::vector<std::filesystem::path> GetCppFiles(const std::filesystem::path& dir)
 
 void CheckDir(const std::filesystem::path& dir,
               const std::optional<std::filesystem::path>& dict = std::nullopt);
+
+// Findings sorted by file, line and name, for comparing runs that may report
+// them in a different order.
+Statistics SortedFindings(Statistics stats);
+
+// A project in a fresh temporary directory, removed by the destructor.
+class TempProject {
+public:
+    explicit TempProject(const std::string& name);
+    ~TempProject();
+
+    TempProject(const TempProject&) = delete;
+    TempProject& operator=(const TempProject&) = delete;
+
+    const std::filesystem::path& Root() const {
+        return root_;
+    }
+
+    // Writes a file relative to the root, and returns its full path.
+    std::string Write(const std::string& name, const std::string& contents) const;
+
+    // Adds a command that compiles a file relative to the root. The commands
+    // are only written to compile_commands.json by WriteCommands.
+    void AddCommand(const std::string& name, const std::string& flags = "-std=c++20");
+    void WriteCommands() const;
+
+private:
+    std::filesystem::path root_;
+    std::vector<std::pair<std::string, std::string>> commands_;  // File and flags
+};
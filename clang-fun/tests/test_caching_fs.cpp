@@ -0,0 +1,140 @@
+#include "../checker/caching_fs.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <unistd.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+// A fresh directory with a file in each of two subdirectories.
+struct Tree {
+    fs::path root;
+
+    Tree() {
+        root = fs::temp_directory_path() / ("check_names_fs_" + std::to_string(getpid()));
+        fs::remove_all(root);
+        for (const auto* dir : {"one", "two"}) {
+            fs::create_directories(root / dir);
+            std::ofstream{root / dir / "file.txt"} << dir;
+        }
+    }
+
+    ~Tree() {
+        std::error_code error;
+        fs::remove_all(root, error);
+    }
+};
+
+std::string Contents(llvm::vfs::FileSystem& file_system, const std::string& path) {
+    auto buffer = file_system.getBufferForFile(path);
+    REQUIRE(buffer);
+    return (*buffer)->getBuffer().str();
+}
+
+}  // namespace
+
+TEST_CASE("CachingFsWorkingDirectory") {
+    Tree tree;
+    auto process_dir = fs::current_path();
+    FileSystemCache cache;
+    CachingFileSystem first{cache}, second{cache};
+
+    // Each tool resolves relative paths against its own directory.
+    REQUIRE_FALSE(first.setCurrentWorkingDirectory((tree.root / "one").string()));
+    REQUIRE_FALSE(second.setCurrentWorkingDirectory((tree.root / "two").string()));
+    CHECK(Contents(first, "file.txt") == "one");
+    CHECK(Contents(second, "file.txt") == "two");
+    CHECK(Contents(first, "../two/./file.txt") == "two");
+    CHECK(*first.getCurrentWorkingDirectory() == (tree.root / "one").string());
+    CHECK(fs::current_path() == process_dir);
+
+    // Status keeps the name the file was asked for.
+    auto status = second.status("file.txt");
+    REQUIRE(status);
+    CHECK(status->getName() == "file.txt");
+
+    CHECK(first.setCurrentWorkingDirectory("missing"));
+    CHECK(first.setCurrentWorkingDirectory("file.txt"));
+    CHECK(*first.getCurrentWorkingDirectory() == (tree.root / "one").string());
+}
+
+TEST_CASE("CachingFsMissingFiles") {
+    Tree tree;
+    FileSystemCache cache;
+    CachingFileSystem tool{cache};
+    auto path = (tree.root / "one" / "late.txt").string();
+    CHECK_FALSE(tool.status(path));
+
+    // A file created during the run stays missing for all tools, as it would
+    // be in the middle of a build.
+    std::ofstream{path} << "late";
+    CHECK_FALSE(tool.status(path));
+    CHECK_FALSE(tool.openFileForRead(path));
+    CachingFileSystem other{cache};
+    CHECK_FALSE(other.status(path));
+    CHECK(FileSystemCache{}.status(path));
+}
+
+TEST_CASE("CachingFsDirectoryListing") {
+    Tree tree;
+    FileSystemCache cache;
+    CachingFileSystem tool{cache};
+    REQUIRE_FALSE(tool.setCurrentWorkingDirectory(tree.root.string()));
+
+    auto list = [&](const std::string& dir) {
+        std::vector<std::string> names;
+        std::error_code error;
+        for (auto it = tool.dir_begin(dir, error), end = llvm::vfs::directory_iterator();
+             !error && it != end; it.increment(error)) {
+            names.push_back(it->path().str());
+        }
+        REQUIRE_FALSE(error);
+        return names;
+    };
+
+    // The same cached listing is named after the directory as given.
+    auto absolute = (tree.root / "one").string();
+    CHECK(list("one") == std::vector<std::string>{"one/file.txt"});
+    CHECK(list("./one") == std::vector<std::string>{"./one/file.txt"});
+    CHECK(list(absolute) == std::vector<std::string>{absolute + "/file.txt"});
+
+    std::error_code error;
+    tool.dir_begin("missing", error);
+    CHECK(error);
+}
+
+TEST_CASE("CachingFsReadAhead") {
+    Tree tree;
+    std::vector<std::string> files;
+    for (size_t i = 0; i < 100; ++i) {
+        files.push_back((tree.root / "one" / ("file_" + std::to_string(i) + ".txt")).string());
+        std::ofstream{files.back()} << i;
+    }
+    FileSystemCache cache;
+
+    // The thread waits for files to be started, and stops at destruction
+    // however many are still to be read.
+    { ReadAhead read_ahead(cache, files, 2); }
+    {
+        ReadAhead read_ahead(cache, files, 2);
+        read_ahead.started(0);
+        read_ahead.started(10);
+    }
+    {
+        ReadAhead read_ahead(cache, files, 2);
+        for (size_t i = 0; i < files.size(); ++i) {
+            read_ahead.started(i);
+        }
+    }
+
+    CachingFileSystem tool{cache};
+    CHECK(Contents(tool, files[42]) == "42");
+}
@@ -1,9 +1,587 @@
 #include "common.h"
 #include "util.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <catch2/catch_test_macros.hpp>
 
 TEST_CASE("Dict") {
     auto dir = GetFileDir(__FILE__) / "dict";
     CheckDir(dir , dir / "dict.txt");
 }
+
+TEST_CASE("DictBuffers") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+
+    // Each buffer starts with an extra line that the file on disk does not
+    // have, so findings in main files move down by one and those in headers
+    // stay where they are.
+    std::vector<SourceBuffer> buffers;
+    for (const auto& file : GetCppFiles(dir)) {
+        std::ifstream in{file};
+        buffers.push_back({file, "\n" + std::string{std::istreambuf_iterator<char>{in}, {}}});
+        auto& stats = expected[file.filename()];
+        for (auto& bad_name : stats.bad_names) {
+            bad_name.line += bad_name.file == file.filename();
+        }
+        for (auto& mistake : stats.mistakes) {
+            mistake.line += mistake.file == file.filename();
+        }
+    }
+    REQUIRE_FALSE(buffers.empty());
+
+    // A buffer that does not exist on disk at all.
+    buffers.push_back({dir / "unsaved.cpp", "#include \"set.h\"\n\nint BadName = 0;\n"});
+
+    auto result = CheckBuffers(buffers, {"-std=c++20"}, dir / "dict.txt");
+    auto unsaved = result["unsaved.cpp"];
+    result.erase("unsaved.cpp");
+    CHECK(result == expected);
+
+    auto bad_name = std::find_if(unsaved.bad_names.begin(), unsaved.bad_names.end(),
+                                 [](const auto& x) { return x.file == "unsaved.cpp"; });
+    REQUIRE(bad_name != unsaved.bad_names.end());
+    CHECK(*bad_name == BadName{"unsaved.cpp", "BadName", Entity::kVariable, 3});
+    CHECK(unsaved.bad_names.size() > 1);  // Names of set.h
+}
+
+TEST_CASE("DictSession") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    CheckSession session{{"-std=c++20"}, dir / "dict.txt"};
+
+    for (const auto& file : GetCppFiles(dir)) {
+        std::ifstream in{file};
+        SourceBuffer buffer{file, {std::istreambuf_iterator<char>{in}, {}}};
+        // The second check reuses the preamble built by the first one.
+        CHECK(session.Check(buffer) == expected[file.filename()]);
+        CHECK(session.Check(buffer) == expected[file.filename()]);
+    }
+
+    // A file that cannot be parsed at all is not reported as clean.
+    CheckSession broken{{"-std=c++20", "-Xclang", "-check-names-no-such-option"}};
+    SourceBuffer buffer{dir / "unparsed.cpp", "int BadName = 0;\n"};
+    auto stats = broken.Check(buffer);
+    CHECK(stats.incomplete);
+    CHECK(stats.bad_names.empty());
+    CHECK(broken.Check(buffer).incomplete);
+}
+
+TEST_CASE("DictBaseline") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    auto baseline = std::filesystem::temp_directory_path() / "check_names_baseline.bin";
+    WriteBaseline(expected, baseline);
+
+    auto stats = expected;
+    auto& test_file = stats["test_file.cpp"];
+    // Moving a known violation to another line keeps it suppressed,
+    // a new violation is still reported.
+    test_file.bad_names.front().line += 10;
+    test_file.bad_names.push_back({"test_file.cpp", "NewBad_", Entity::kVariable, 100});
+
+    SuppressBaseline(&stats, baseline);
+    std::filesystem::remove(baseline);
+
+    for (const auto& [file, result] : stats) {
+        INFO(file);
+        CHECK(result.mistakes.empty());
+        if (file == "test_file.cpp") {
+            REQUIRE(result.bad_names.size() == 1);
+            CHECK(result.bad_names.front().name == "NewBad_");
+        } else {
+            CHECK(result.bad_names.empty());
+        }
+    }
+}
+
+TEST_CASE("DictStatistics") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    expected["some.cpp"].incomplete = true;
+    // A failed write is reported instead of aborting
+    WriteStatistics(expected, "/dev/full");
+    auto path = std::filesystem::temp_directory_path() / "check_names_stats.bin";
+    WriteStatistics(expected, path);
+
+    std::unordered_map<std::string, Statistics> result;
+    REQUIRE(ReadStatistics(path, &result));
+    std::filesystem::remove(path);
+    CHECK(result == expected);
+}
+
+TEST_CASE("DictMerge") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    TempProject project{"check_names_sidecars"};
+    const auto& work = project.Root();
+
+    // One sidecar per translation unit, as the plugin writes them, and one
+    // more for each file compiled a second time.
+    std::vector<std::string> sidecars;
+    for (const auto& [file, stats] : expected) {
+        for (const auto* suffix : {".o.names", ".pic.o.names"}) {
+            sidecars.push_back((work / (file + suffix)).string());
+            WriteStatistics({{file, stats}}, sidecars.back());
+        }
+    }
+    std::unordered_map<std::string, Statistics> result;
+    REQUIRE(MergeStatistics(sidecars, &result));
+    CHECK(result == expected);
+
+    sidecars.push_back((work / "missing.o.names").string());
+    CHECK_FALSE(MergeStatistics(sidecars, &result));
+}
+
+TEST_CASE("DictQuick") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    auto dict = (dir / "dict.txt").string();
+    std::vector args = {"./test_check_names", "-p", ".", "-dict", dict.c_str()};
+    auto files = GetCppFiles(dir);
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+
+    auto run = [&](bool quick) {
+        auto quick_args = args;
+        if (quick) {
+            quick_args.push_back("-quick");
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto result = CheckNames(quick_args.size(), quick_args.data());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return std::pair{result, elapsed.count()};
+    };
+    auto [full, full_time] = run(false);
+    auto [quick, quick_time] = run(true);
+    CHECK(full == expected);
+
+    // Suggestions of the full mode include hand-picked words, so findings
+    // are matched without them.
+    auto same = [](const Mistake& a, const Mistake& b) {
+        return a.file == b.file && a.name == b.name && a.wrong_word == b.wrong_word &&
+               a.line == b.line;
+    };
+    size_t quick_total = 0, full_total = 0, matched = 0;
+    for (const auto& [file, stats] : quick) {
+        INFO(file);
+        CHECK(stats.bad_names.empty());
+        const auto& reference = full[file].mistakes;
+        quick_total += stats.mistakes.size();
+        for (const auto& mistake : stats.mistakes) {
+            matched += std::any_of(reference.begin(), reference.end(),
+                                   [&](const Mistake& m) { return same(m, mistake); });
+        }
+    }
+    for (const auto& [file, stats] : full) {
+        full_total += stats.mistakes.size();
+    }
+
+    WARN("quick mode: precision " << matched << "/" << quick_total << ", recall " << matched
+                                  << "/" << full_total << ", " << quick_time << "s vs "
+                                  << full_time << "s");
+    CHECK(matched > 0);
+
+    // There are no style violations for -fix to rename, so the run is refused
+    args.push_back("-quick");
+    args.push_back("-fix");
+    CHECK(CheckNames(args.size(), args.data()).empty());
+}
+
+TEST_CASE("DictSummary") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    auto dict = (dir / "dict.txt").string();
+    std::vector args = {"./test_check_names", "-p", ".", "-dict", dict.c_str(), "-summary-top", "3"};
+    auto files = GetCppFiles(dir);
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+    auto summary = SummarizeNames(args.size(), args.data());
+
+    // The counts add up to the full results, all in the one test directory.
+    std::map<Entity, size_t> expected_entities, entities;
+    std::map<std::string, size_t> names;
+    size_t expected_typos = 0, typos = 0;
+    for (const auto& [file, stats] : expected) {
+        for (const auto& bad : stats.bad_names) {
+            ++expected_entities[bad.entity];
+            ++names[bad.name];
+        }
+        for (const auto& mistake : stats.mistakes) {
+            ++names[mistake.name];
+        }
+        expected_typos += stats.mistakes.size();
+    }
+    auto real_dir = std::filesystem::canonical(dir).string();
+    for (const auto& count : summary.bad_names) {
+        CHECK(count.directory == real_dir);
+        entities[count.entity] += count.count;
+    }
+    for (const auto& [directory, count] : summary.typos) {
+        CHECK(directory == real_dir);
+        typos += count;
+    }
+    CHECK(entities == expected_entities);
+    CHECK(typos == expected_typos);
+    CHECK_FALSE(summary.incomplete);
+
+    // Counts of the sketch are upper bounds, off by at most their error.
+    REQUIRE(summary.top_names.size() == 3);
+    for (const auto& top : summary.top_names) {
+        INFO(top.name);
+        CHECK(top.count >= names[top.name]);
+        CHECK(top.count - top.error <= names[top.name]);
+    }
+
+    // No names are kept, but the workers still merge their counts.
+    args[6] = "0";
+    args.insert(args.begin() + 7, {"-j", "2"});
+    auto counts_only = SummarizeNames(args.size(), args.data());
+    CHECK(counts_only.top_names.empty());
+    CHECK(counts_only.bad_names == summary.bad_names);
+    CHECK(counts_only.typos == summary.typos);
+}
+
+TEST_CASE("DictEstimate") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    auto dict = (dir / "dict.txt").string();
+    std::vector args = {"./test_check_names", "-p", ".", "-dict", dict.c_str()};
+    auto files = GetCppFiles(dir);
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+
+    // Without -sample every file is checked and the rates are exact.
+    auto census = EstimateNames(args.size(), args.data());
+    size_t total = 0;
+    for (const auto& [file, stats] : expected) {
+        total += stats.bad_names.size() + stats.mistakes.size();
+    }
+    double rate = static_cast<double>(total) / files.size();
+    REQUIRE(census.directories.size() == 1);
+    CHECK(census.directories.front().checked == files.size());
+    CHECK(census.files == files.size());
+    CHECK(census.checked == files.size());
+    CHECK(std::abs(census.violations.rate - rate) < 1e-9);
+    CHECK(census.violations.low == census.violations.rate);
+    CHECK(census.violations.high == census.violations.rate);
+    CHECK_FALSE(census.incomplete);
+
+    // A sample is the same on every run, and its interval covers its rate.
+    args.push_back("-sample");
+    args.push_back("2");
+    auto sample = EstimateNames(args.size(), args.data());
+    CHECK(sample == EstimateNames(args.size(), args.data()));
+    CHECK(sample.files == files.size());
+    CHECK(sample.checked == 2);
+    CHECK(sample.violations.low <= sample.violations.rate);
+    CHECK(sample.violations.rate <= sample.violations.high);
+}
+
+TEST_CASE("DictEstimateDirectories") {
+    // Three directories of two files each
+    TempProject project{"check_names_sample"};
+    std::vector<std::string> files;
+    for (const auto* dir : {"one", "two", "three"}) {
+        for (const auto* file : {"a.cpp", "b.cpp"}) {
+            auto name = std::string{dir} + "/" + file;
+            files.push_back(project.Write(name, "int BadName = 0;\n"));
+            project.AddCommand(name);
+        }
+    }
+    project.WriteCommands();
+
+    auto root = project.Root().string();
+    std::vector args = {"./test_check_names", "-p", root.c_str(), "-sample", "2"};
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+    auto sample = EstimateNames(args.size(), args.data());
+
+    // With fewer files to check than directories, the sample keeps its size
+    // and leaves a directory out.
+    size_t covered = 0;
+    for (const auto& directory : sample.directories) {
+        CHECK(directory.checked <= 1);
+        covered += directory.checked;
+    }
+    CHECK(sample.files == 6);
+    CHECK(sample.checked == 2);
+    CHECK(covered == 2);
+    CHECK(sample.incomplete);
+}
+
+TEST_CASE("DictJumbo") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    auto dict = (dir / "dict.txt").string();
+    std::vector args = {"./test_check_names", "-p", ".", "-dict", dict.c_str(), "-jumbo", "8"};
+    for (const auto& file : GetCppFiles(dir)) {
+        args.push_back(file.c_str());
+    }
+    auto result = CheckNames(args.size(), args.data());
+
+    // Whether the files compile together or are parsed one by one, every
+    // finding is attributed to the file that includes it.
+    REQUIRE(result.size() == expected.size());
+    for (const auto& [file, stats] : expected) {
+        INFO(file);
+        CHECK(SortedFindings(result[file]) == SortedFindings(stats));
+    }
+}
+
+TEST_CASE("DictJumboBatch") {
+    // Files without a main function and with the same command compile as one
+    // batch. The header is entered once, by the first file, and skipped by its
+    // include guard in the second.
+    TempProject project{"check_names_jumbo"};
+    project.Write("shared.h", "#pragma once\n\ninline int SharedBad = 0;\n");
+    std::vector<std::string> files = {
+        project.Write("first.cpp", "#include \"shared.h\"\n\nint FirstBad = SharedBad;\n"),
+        project.Write("second.cpp", "#include \"shared.h\"\n\nint SecondBad = SharedBad + 1;\n"),
+        project.Write("third.cpp", "int ThirdBad = 0;\n")};
+    for (const auto* name : {"first.cpp", "second.cpp", "third.cpp"}) {
+        project.AddCommand(name);
+    }
+    project.WriteCommands();
+
+    auto root = project.Root().string();
+    std::vector args = {"./test_check_names", "-p", root.c_str()};
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+    auto separate = CheckNames(args.size(), args.data());
+    args.insert(args.begin() + 3, {"-jumbo", "8"});
+    auto jumbo = CheckNames(args.size(), args.data());
+
+    // The header is reported for both files that include it, in the order of
+    // their own findings, and not for the file that does not.
+    BadName shared_bad{"shared.h", "SharedBad", Entity::kVariable, 3};
+    CHECK(jumbo["first.cpp"].bad_names ==
+          std::vector{shared_bad, BadName{"first.cpp", "FirstBad", Entity::kVariable, 3}});
+    CHECK(jumbo["second.cpp"].bad_names ==
+          std::vector{shared_bad, BadName{"second.cpp", "SecondBad", Entity::kVariable, 3}});
+    CHECK(jumbo["third.cpp"].bad_names ==
+          std::vector{BadName{"third.cpp", "ThirdBad", Entity::kVariable, 1}});
+    CHECK(jumbo == separate);
+}
+
+TEST_CASE("DictJumboFailFast") {
+    // The batch does not compile, since both files define Helper
+    TempProject project{"check_names_jumbo_fail_fast"};
+    std::vector<std::string> files = {
+        project.Write("first.cpp", "static int Helper() { return 1; }\nint FirstBad = Helper();\n"),
+        project.Write("second.cpp",
+                      "static int Helper() { return 2; }\nint SecondBad = Helper();\n")};
+    project.AddCommand("first.cpp");
+    project.AddCommand("second.cpp");
+    project.WriteCommands();
+
+    auto root = project.Root().string();
+    std::vector args = {"./test_check_names", "-p", root.c_str(), "-jumbo", "8", "-fail-fast"};
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+    auto result = CheckNames(args.size(), args.data());
+
+    // Findings of the failed batch are thrown away without stopping the run,
+    // so the separate parse of the first file reports its finding.
+    CHECK(result["first.cpp"].bad_names ==
+          std::vector{BadName{"first.cpp", "FirstBad", Entity::kVariable, 2}});
+    CHECK_FALSE(result["first.cpp"].incomplete);
+    CHECK((!result["second.cpp"].bad_names.empty() || result["second.cpp"].incomplete));
+}
+
+TEST_CASE("DictConfigurations") {
+    TempProject project{"check_names_configs"};
+    auto source = project.Write("configs.cpp",
+                                "#ifdef OTHER_CONFIG\n#include \"other.h\"\nint OtherBad_ = 0;\n"
+                                "#endif\nint ThisBad_ = 0;\n");
+    // Only the third command includes the header at all
+    project.Write("other.h", "#pragma once\n\nint OtherHeaderBad_ = 0;\n");
+    // Debug and release only differ in code generation, the third command
+    // enables another branch.
+    for (const auto* flags : {"-O0 -g", "-O2", "-O2 -DOTHER_CONFIG"}) {
+        project.AddCommand("configs.cpp", std::string{"-std=c++20 "} + flags);
+    }
+    project.WriteCommands();
+
+    auto root = project.Root().string();
+    std::vector args = {"./test_check_names", "-p", root.c_str(), source.c_str()};
+    auto first = CheckNames(args.size(), args.data());
+    args.push_back("-all-configs");
+    auto all = CheckNames(args.size(), args.data());
+
+    // Each finding is reported once, however many commands list the file.
+    BadName this_bad{"configs.cpp", "ThisBad_", Entity::kVariable, 5};
+    BadName other_bad{"configs.cpp", "OtherBad_", Entity::kVariable, 3};
+    BadName header_bad{"other.h", "OtherHeaderBad_", Entity::kVariable, 3};
+    CHECK(first["configs.cpp"].bad_names == std::vector{this_bad});
+    CHECK(all["configs.cpp"].bad_names == std::vector{this_bad, header_bad, other_bad});
+}
+
+TEST_CASE("DictConfigurationsSameName") {
+    TempProject project{"check_names_configs_same_name"};
+    auto source = project.Write("configs.cpp",
+                                "#include \"a/util.h\"\n#ifdef OTHER_CONFIG\n"
+                                "#include \"b/util.h\"\n#endif\n");
+    project.Write("a/util.h", "#pragma once\n\nint FirstBad_ = 0;\n");
+    // Only the second command includes this header, which has the same name
+    // as one the first command does include.
+    project.Write("b/util.h", "#pragma once\n\nint SecondBad_ = 0;\n");
+    for (const auto* flags : {"-std=c++20", "-std=c++20 -DOTHER_CONFIG"}) {
+        project.AddCommand("configs.cpp", flags);
+    }
+    project.WriteCommands();
+
+    auto root = project.Root().string();
+    std::vector args = {"./test_check_names", "-p", root.c_str(), source.c_str(), "-all-configs"};
+    auto all = CheckNames(args.size(), args.data());
+
+    BadName first_bad{"util.h", "FirstBad_", Entity::kVariable, 3};
+    BadName second_bad{"util.h", "SecondBad_", Entity::kVariable, 3};
+    CHECK(all["configs.cpp"].bad_names == std::vector{first_bad, second_bad});
+}
+
+TEST_CASE("DictNamingConfig") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto expected = ReadExpected(dir / "expected.txt");
+    auto config = std::filesystem::temp_directory_path() / "check_names_policy.cfg";
+    {
+        // No type name in the directory is long enough.
+        std::ofstream out{config};
+        out << "[" << dir.string() << "]\ntype.min-length = 100\n";
+    }
+
+    auto dict = (dir / "dict.txt").string();
+    auto config_path = config.string();
+    std::vector args = {"./test_check_names", "-p", ".", "-dict", dict.c_str(),
+                        "-naming-config", config_path.c_str()};
+    auto files = GetCppFiles(dir);
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+    auto result = CheckNames(args.size(), args.data());
+    std::filesystem::remove(config);
+
+    size_t new_types = 0;
+    for (const auto& [file, stats] : expected) {
+        INFO(file);
+        const auto& bad_names = result[file].bad_names;
+        for (const auto& bad : stats.bad_names) {
+            CHECK(std::find(bad_names.begin(), bad_names.end(), bad) != bad_names.end());
+        }
+        for (const auto& bad : bad_names) {
+            new_types += bad.entity == Entity::kType &&
+                         std::find(stats.bad_names.begin(), stats.bad_names.end(), bad) ==
+                             stats.bad_names.end();
+        }
+    }
+    CHECK(new_types > 0);
+}
+
+TEST_CASE("DictFailFast") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto files = GetCppFiles(dir);
+    REQUIRE(files.size() > 1);
+
+    auto dict = (dir / "dict.txt").string();
+    std::vector args = {"./test_check_names", "-p", ".", "-fail-fast", "-dict", dict.c_str()};
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+    auto result = CheckNames(args.size(), args.data());
+
+    // Every file either contributed findings before the stop or was skipped.
+    size_t with_findings = 0;
+    for (const auto& file : files) {
+        INFO(file);
+        const auto& stats = result[file.filename()];
+        bool found = !stats.bad_names.empty() || !stats.mistakes.empty();
+        with_findings += found;
+        CHECK((found || stats.incomplete));
+    }
+    CHECK(with_findings > 0);
+    CHECK(with_findings < files.size());
+}
+
+TEST_CASE("DictFix") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    TempProject project{"check_names_fix"};
+    auto work = project.Root();
+    for (const auto* name : {"bit_field.cpp", "bit_field.h"}) {
+        std::filesystem::copy_file(dir / name, work / name);
+    }
+    auto source = (work / "bit_field.cpp").string();
+
+    std::vector args = {"./test_check_names", "-p", ".", "-fix", source.c_str()};
+    auto before = CheckNames(args.size(), args.data());
+    args.erase(args.begin() + 3);
+    auto after = CheckNames(args.size(), args.data());
+    auto read = [](const std::filesystem::path& path) {
+        std::ifstream in{path};
+        return std::string{std::istreambuf_iterator<char>{in}, {}};
+    };
+    auto header = read(work / "bit_field.h");
+    auto code = read(work / "bit_field.cpp");
+
+    CHECK(before["bit_field.cpp"].bad_names ==
+          ReadExpected(dir / "expected.txt")["bit_field.cpp"].bad_names);
+
+    // The fields, the const parameters and the local variable are renamed
+    // with all of their uses. The class has no valid respelling, so it and
+    // its constructors are still reported.
+    std::vector<BadName> expected = {
+        {"bit_field.h", "TBitField", Entity::kType, 7},
+        {"bit_field.h", "TBitField", Entity::kFunction, 14},
+        {"bit_field.h", "TBitField", Entity::kFunction, 15},
+        {"bit_field.h", "TBitField", Entity::kFunction, 16},
+        {"bit_field.h", "~TBitField", Entity::kFunction, 17},
+        {"bit_field.cpp", "TBitField", Entity::kFunction, 7},
+        {"bit_field.cpp", "TBitField", Entity::kFunction, 17},
+        {"bit_field.cpp", "TBitField", Entity::kFunction, 34},
+        {"bit_field.cpp", "~TBitField", Entity::kFunction, 45},
+    };
+    CHECK(after["bit_field.cpp"].bad_names == expected);
+    CHECK(after["bit_field.cpp"].mistakes.empty());
+    for (const auto* name : {"BitLen", "MemLen", "pMem", "Source"}) {
+        INFO(name);
+        CHECK(header.find(name) == std::string::npos);
+        CHECK(code.find(name) == std::string::npos);
+    }
+    CHECK(header.find("int bit_len_;") != std::string::npos);
+    CHECK(header.find("void ClrBit(const int kN);") != std::string::npos);
+    CHECK(code.find("bit_len_ = bf.bit_len_;") != std::string::npos);
+    CHECK(code.find("int source=1;") != std::string::npos);
+}
+
+TEST_CASE("DictFixClash") {
+    TempProject project{"check_names_fix_clash"};
+    project.Write("counter.h", "extern int GlobalCount;\n");
+    auto counter = project.Write("counter.cpp", "#include \"counter.h\"\nint GlobalCount = 1;\n");
+    auto user = project.Write("user.cpp", "#include \"counter.h\"\nint global_count = 0;\n"
+                                          "int Use() { return GlobalCount + global_count; }\n");
+
+    std::vector args = {"./test_check_names", "-p", ".", "-fix", "-j", "2",
+                        counter.c_str(), user.c_str()};
+    CheckNames(args.size(), args.data());
+    std::ifstream in{project.Root() / "counter.h"};
+    std::string header{std::istreambuf_iterator<char>{in}, {}};
+
+    // Only user.cpp sees the clashing global_count, but the rename is dropped
+    // in every file, so its reference to GlobalCount still compiles.
+    CHECK(header == "extern int GlobalCount;\n");
+}
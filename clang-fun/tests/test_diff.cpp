@@ -0,0 +1,89 @@
+#include "common.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <sys/wait.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Runs check_names_diff on two results files, returns its exit code and output.
+std::pair<int, std::string> RunDiff(const std::string& old_path, const std::string& new_path) {
+    auto command = std::string{CHECK_NAMES_DIFF} + " " + old_path + " " + new_path + " 2>&1";
+    auto* pipe = popen(command.c_str(), "r");
+    REQUIRE(pipe);
+    std::string output;
+    char buffer[256];
+    while (auto size = fread(buffer, 1, sizeof(buffer), pipe)) {
+        output.append(buffer, size);
+    }
+    int status = pclose(pipe);
+    REQUIRE(WIFEXITED(status));
+    return {WEXITSTATUS(status), output};
+}
+
+}  // namespace
+
+TEST_CASE("Diff") {
+    auto work = std::filesystem::temp_directory_path() / "check_names_diff";
+    std::filesystem::remove_all(work);
+    std::filesystem::create_directories(work);
+    auto old_path = (work / "old.cns").string();
+    auto new_path = (work / "new.cns").string();
+
+    std::unordered_map<std::string, Statistics> old_stats, new_stats;
+    old_stats["a.cpp"].bad_names = {{"a.cpp", "BadName", Entity::kVariable, 3},
+                                    {"a.h", "pMem", Entity::kField, 10}};
+    old_stats["a.cpp"].mistakes = {{"a.cpp", "wrnog_name", "wrnog", "wrong", 9}};
+    old_stats["gone.cpp"].bad_names = {{"gone.cpp", "X", Entity::kType, 1}};
+
+    SECTION("Unchanged") {
+        WriteStatistics(old_stats, old_path);
+        WriteStatistics(old_stats, new_path);
+        auto [code, output] = RunDiff(old_path, new_path);
+        CHECK(code == 0);
+        CHECK(output == "0 added, 0 removed, 0 moved\n");
+    }
+
+    SECTION("Removed and moved") {
+        // Lines above the violation were added, the typo and a file are gone
+        new_stats["a.cpp"].bad_names = {{"a.cpp", "BadName", Entity::kVariable, 5},
+                                        {"a.h", "pMem", Entity::kField, 10}};
+        WriteStatistics(old_stats, old_path);
+        WriteStatistics(new_stats, new_path);
+        auto [code, output] = RunDiff(old_path, new_path);
+        CHECK(code == 0);
+        CHECK(output ==
+              "~ a.cpp:3 -> 5: variable BadName\n"
+              "- a.cpp:9: typo wrnog -> wrong in wrnog_name\n"
+              "- gone.cpp:1: type X\n"
+              "0 added, 2 removed, 1 moved\n");
+    }
+
+    SECTION("Added") {
+        new_stats = old_stats;
+        new_stats["a.cpp"].bad_names.push_back({"a.h", "pMem", Entity::kField, 20});
+        new_stats["new.cpp"].mistakes = {{"new.cpp", "lenght", "lenght", "length", 2}};
+        WriteStatistics(old_stats, old_path);
+        WriteStatistics(new_stats, new_path);
+        auto [code, output] = RunDiff(old_path, new_path);
+        CHECK(code == 1);
+        CHECK(output ==
+              "+ a.h:20: field pMem\n"
+              "+ new.cpp:2: typo lenght -> length in lenght\n"
+              "2 added, 0 removed, 0 moved\n");
+    }
+
+    SECTION("Missing file") {
+        WriteStatistics(old_stats, old_path);
+        auto [code, output] = RunDiff(old_path, (work / "missing.cns").string());
+        CHECK(code == 2);
+    }
+
+    std::filesystem::remove_all(work);
+}
@@ -0,0 +1,77 @@
+#include "common.h"
+#include "util.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Compiles a file with the plugin loaded, and returns the exit status.
+int CompileWithPlugin(const std::string& source, const std::string& object,
+                      const std::string& options) {
+    auto command = std::string{CHECK_NAMES_CLANG} + " -std=c++20 -w -c " + options +
+                   " -fplugin=" + CHECK_NAMES_PLUGIN + " -o " + object + " " + source +
+                   " 2>/dev/null";
+    return std::system(command.c_str());
+}
+
+}  // namespace
+
+TEST_CASE("Plugin") {
+    auto dir = GetFileDir(__FILE__) / "dict";
+    auto dict = (dir / "dict.txt").string();
+    TempProject project{"check_names_plugin"};
+    const auto& work = project.Root();
+    std::filesystem::create_directories(work / "pic");
+
+    std::vector args = {"./test_check_names", "-p", ".", "-dict", dict.c_str()};
+    auto files = GetCppFiles(dir);
+    for (const auto& file : files) {
+        args.push_back(file.c_str());
+    }
+    auto expected = CheckNames(args.size(), args.data());
+
+    // Every file is compiled twice, as for a static and a shared library, and
+    // each compilation writes a sidecar next to its object file.
+    std::vector<std::string> sidecars;
+    for (const auto& file : files) {
+        for (const auto* variant : {"", "pic/"}) {
+            auto object = (work / variant / file.filename()).string() + ".o";
+            auto options = std::string{*variant ? "-fPIC " : ""} +
+                           "-fplugin-arg-check_names-dict=" + dict;
+            INFO(file);
+            REQUIRE(CompileWithPlugin(file.string(), object, options) == 0);
+            sidecars.push_back(object + ".names");
+        }
+    }
+
+    std::unordered_map<std::string, Statistics> merged;
+    REQUIRE(MergeStatistics(sidecars, &merged));
+    CHECK(merged == expected);
+}
+
+TEST_CASE("PluginBrokenBuild") {
+    TempProject project{"check_names_plugin_broken"};
+    auto source = project.Write("unit.cpp", "int BadName = 0;\n");
+    auto object = (project.Root() / "unit.o").string();
+    std::vector<std::string> sidecars = {object + ".names"};
+
+    REQUIRE(CompileWithPlugin(source, object, "") == 0);
+    std::unordered_map<std::string, Statistics> merged;
+    REQUIRE(MergeStatistics(sidecars, &merged));
+    CHECK(merged["unit.cpp"].bad_names ==
+          std::vector{BadName{"unit.cpp", "BadName", Entity::kVariable, 1}});
+
+    // The sidecar of the clean build is replaced, not merged as current.
+    project.Write("unit.cpp", "int BadName = ;\n");
+    REQUIRE(CompileWithPlugin(source, object, "") != 0);
+    merged.clear();
+    REQUIRE(MergeStatistics(sidecars, &merged));
+    CHECK(merged["unit.cpp"].bad_names.empty());
+    CHECK(merged["unit.cpp"].incomplete);
+}
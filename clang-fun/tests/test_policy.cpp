@@ -0,0 +1,164 @@
+#include "../checker/naming_policy.h"
+
+#include <algorithm>
+#include <cctype>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+// The regex-based rules that the default policy replaced, as the reference
+// for the compiled rules.
+namespace reference {
+
+bool ContainsDigits(const std::string& name) {
+    return std::any_of(name.begin(), name.end(), [](char c) { return std::isdigit(c); });
+}
+
+bool IsValidVariableName(const std::string& name) {
+    if (name.empty() || name == "_" || name[0] == '_') {
+        return false;
+    }
+    static const std::regex pattern("^[a-z][a-z0-9_]*$");
+    return std::regex_match(name, pattern) && name.back() != '_' &&
+           name.find("__") == std::string::npos && !ContainsDigits(name);
+}
+
+bool IsValidNonPublicFieldName(const std::string& name) {
+    static const std::regex pattern("^[a-z][a-z0-9_]*_$");
+    return std::regex_match(name, pattern) && name.find("__") == std::string::npos &&
+           !ContainsDigits(name);
+}
+
+bool IsValidTypeName(const std::string& name) {
+    if (name.empty() || !std::isupper(name[0]) || name.find('_') != std::string::npos) {
+        return false;
+    }
+    if (std::none_of(name.begin(), name.end(), [](char c) { return std::islower(c); })) {
+        return false;
+    }
+    size_t i = 0;
+    while (i < name.length()) {
+        if (std::isupper(name[i])) {
+            size_t j = i + 1;
+            while (j < name.length() && std::isupper(name[j])) {
+                j++;
+            }
+            bool is_acronym = (i == 0) || std::islower(name[i - 1]);
+            if (is_acronym && j - i > 1 && j - i < 3) {
+                return false;
+            }
+            i = j;
+        } else {
+            i++;
+        }
+    }
+    return !ContainsDigits(name);
+}
+
+bool IsValidConstName(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    static const std::regex pattern("^k[A-Z][a-zA-Z0-9]*$");
+    return std::regex_match(name, pattern) && name.back() != '_' && !ContainsDigits(name);
+}
+
+bool IsValidSnakeCaseFunctionName(const std::string& name) {
+    if (name.empty() || !std::islower(name[0])) {
+        return false;
+    }
+    for (const auto* prefix : {"is_", "has_", "can_", "should_", "does_", "was_", "get_", "set_"}) {
+        if (name.rfind(prefix, 0) == 0) {
+            return false;
+        }
+    }
+    static const std::regex pattern("^[a-z][a-z0-9_]*$");
+    return std::regex_match(name, pattern) && name.find("__") == std::string::npos &&
+           !ContainsDigits(name);
+}
+
+bool IsValidCamelCaseFunctionName(const std::string& name) {
+    if (name.size() < 2 || !std::isupper(name[0]) || name.find('_') != std::string::npos) {
+        return false;
+    }
+    if (std::none_of(name.begin(), name.end(), [](char c) { return std::islower(c); })) {
+        return false;
+    }
+    size_t i = 0;
+    while (i < name.length()) {
+        if (std::isupper(name[i])) {
+            size_t j = i + 1;
+            while (j < name.length() && std::isupper(name[j])) {
+                j++;
+            }
+            if (j - i > 1 && j - i < 3) {
+                return false;
+            }
+            i = j;
+        } else {
+            i++;
+        }
+    }
+    return !ContainsDigits(name);
+}
+
+bool IsValidMethodName(const std::string& name) {
+    static const std::regex pattern("^[A-Z][a-zA-Z]+$");
+    return name.size() >= 2 && std::regex_match(name, pattern) && !ContainsDigits(name);
+}
+
+bool Matches(NameRule rule, const std::string& name) {
+    switch (rule) {
+        case NameRule::kVariable:
+        case NameRule::kPublicField:
+            return IsValidVariableName(name);
+        case NameRule::kPrivateField:
+            return IsValidNonPublicFieldName(name);
+        case NameRule::kConst:
+        case NameRule::kConstexprFunction:
+            return IsValidConstName(name);
+        case NameRule::kType:
+            return IsValidTypeName(name);
+        case NameRule::kMethod:
+            return IsValidMethodName(name);
+        case NameRule::kSnakeFunction:
+            return IsValidSnakeCaseFunctionName(name);
+        case NameRule::kCamelFunction:
+            return IsValidCamelCaseFunctionName(name);
+    }
+    return false;
+}
+
+}  // namespace reference
+
+TEST_CASE("PolicyDefaults") {
+    const auto& policy = PolicySet::defaults().forFile("test.cpp");
+
+    // Identifiers are drawn from the characters and prefixes that the rules
+    // tell apart, so that every branch of the reference is taken often.
+    const std::string alphabet = "abkxyzABKXYZ_09";
+    const std::vector<std::string> prefixes = {"", "", "", "k", "is_", "get_", "_", "K"};
+    std::mt19937 random{32};
+    size_t mismatches = 0;
+    for (size_t i = 0; i < 50000; ++i) {
+        std::string name = prefixes[random() % prefixes.size()];
+        for (size_t length = random() % 9; length > 0; --length) {
+            name += alphabet[random() % alphabet.size()];
+        }
+        for (size_t rule = 0; rule < kNumNameRules; ++rule) {
+            auto name_rule = static_cast<NameRule>(rule);
+            if (policy.matches(name_rule, name) != reference::Matches(name_rule, name)) {
+                INFO(ruleName(name_rule) << " " << name);
+                CHECK(policy.matches(name_rule, name) == reference::Matches(name_rule, name));
+                ++mismatches;
+            }
+        }
+        if (mismatches > 20) {
+            break;
+        }
+    }
+    CHECK(mismatches == 0);
+}
@@ -0,0 +1,312 @@
+#include "common.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+// Runs a synthetic project of tens of thousands of names against a 100k word
+// dictionary. Runs are always compared with each other, so workers, jumbo
+// batches and summaries that stop paying off fail on any machine. Absolute
+// budgets need a baseline recorded on the same machine
+// (CHECK_NAMES_SCALE_BASELINE, written when CHECK_NAMES_SCALE_RECORD is set),
+// and are skipped without one after everything else is checked. The
+// ThreadSanitizer build runs a smaller project and only checks the results.
+
+namespace {
+
+#ifdef CHECK_NAMES_TSAN
+constexpr size_t kNumFiles = 48;
+#else
+constexpr size_t kNumFiles = 240;
+#endif
+constexpr size_t kNumDirs = 8;
+constexpr size_t kFunctionsPerFile = 25;  // Five names each
+constexpr size_t kDictWords = 100000;
+constexpr size_t kVocabulary = 4000;      // Dictionary words used in names
+constexpr size_t kTypoEvery = 4;          // One function in this many has a typo
+const char* kJobs = "4";
+
+// Budgets relative to the baseline. Time gets some absolute slack too, since
+// ctest may run other tests next to this one.
+constexpr double kTimeSlack = 1.5;
+constexpr double kTimeNoise = 0.25;
+constexpr double kMemorySlack = 1.25;
+
+// Budgets of one run relative to another run of the same test.
+constexpr double kParallelSlack = 1.25;   // -j 4 against -j 1
+constexpr double kJumboSlack = 1.5;       // -jumbo against plain checks
+constexpr double kSummarySlack = 1.5;     // Summary against plain checks
+
+std::string Capitalized(std::string word) {
+    word[0] = static_cast<char>(word[0] - 'a' + 'A');
+    return word;
+}
+
+struct Corpus {
+    TempProject project{"check_names_scale"};
+    std::string root_dir;
+    std::string dict;
+    std::vector<std::string> files;
+
+    Corpus() {
+        root_dir = project.Root().string();
+
+        // std::mt19937 is the same everywhere, so is the corpus
+        std::mt19937 random{20240917};
+        std::set<std::string> words;
+        std::vector<std::string> vocabulary;
+        while (words.size() < kDictWords) {
+            std::string word(4 + random() % 8, 'a');
+            for (auto& c : word) {
+                c = static_cast<char>('a' + random() % 26);
+            }
+            if (words.insert(word).second && vocabulary.size() < kVocabulary) {
+                vocabulary.push_back(word);
+            }
+        }
+        std::string dict_words;
+        for (const auto& word : words) {
+            dict_words += word + '\n';
+        }
+        dict = project.Write("dict.txt", dict_words);
+
+        auto pick = [&] { return vocabulary[random() % vocabulary.size()]; };
+        auto misspelled = [&] {
+            while (true) {
+                auto word = pick();
+                std::swap(word[1], word[2]);
+                if (!words.count(word)) {
+                    return word;
+                }
+            }
+        };
+
+        project.Write("corpus.h", "#pragma once\n\nnamespace corpus {\n\nclass " +
+                                      Capitalized(pick()) + Capitalized(pick()) +
+                                      " {\npublic:\n    int Value(int n) const { return n; }\n};\n\n}\n");
+
+        for (size_t i = 0; i < kNumFiles; ++i) {
+            auto name = "dir_" + std::to_string(i % kNumDirs) + "/unit_" + std::to_string(i) + ".cpp";
+            std::ostringstream out;
+            out << "#include \"corpus.h\"\n\nnamespace unit_" << i << " {\n";
+            std::set<std::string> functions;
+            for (size_t f = 0; f < kFunctionsPerFile; ++f) {
+                auto function = Capitalized(pick()) + Capitalized(pick());
+                while (!functions.insert(function).second) {
+                    function += Capitalized(pick());
+                }
+                auto first = (f % kTypoEvery == 0 ? misspelled() : pick()) + "_" + pick();
+                auto param = pick() + "_" + pick();
+                auto second = pick() + "_" + pick();
+                while (param == first) {
+                    param = pick() + "_" + pick();
+                }
+                while (second == first || second == param) {
+                    second = pick() + "_" + pick();
+                }
+                out << "\nint " << function << "(int " << param << ", int n) {\n"
+                    << "    int " << first << " = " << param << " + n;\n"
+                    << "    int " << second << " = " << first << " * 2;\n"
+                    << "    return " << second << ";\n}\n";
+            }
+            out << "\n}\n";
+
+            files.push_back(project.Write(name, out.str()));
+            project.AddCommand(name, "-std=c++20 -I" + root_dir);
+        }
+        project.WriteCommands();
+    }
+
+    std::vector<const char*> Args(std::initializer_list<const char*> options) const {
+        std::vector<const char*> args = {"./test_check_names", "-p", root_dir.c_str(), "-dict",
+                                         dict.c_str()};
+        args.insert(args.end(), options);
+        for (const auto& file : files) {
+            args.push_back(file.c_str());
+        }
+        return args;
+    }
+};
+
+const Corpus& GetCorpus() {
+    static const Corpus corpus;
+    return corpus;
+}
+
+struct Usage {
+    double seconds;
+    size_t peak_kb;
+};
+
+// VmHWM is the peak resident set of the process; writing 5 to clear_refs
+// resets it to the current size, so each run is measured on its own.
+size_t PeakKb() {
+    std::ifstream status{"/proc/self/status"};
+    for (std::string line; std::getline(status, line);) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stoul(line.substr(6));
+        }
+    }
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+template <class F>
+Usage Measure(F&& run) {
+    std::ofstream{"/proc/self/clear_refs"} << "5";
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return {elapsed.count(), PeakKb()};
+}
+
+// Fails if a run takes much longer than a reference run doing the same work
+// in a way that should be at least as fast.
+void CheckRelativeBudget([[maybe_unused]] const Usage& usage,
+                         [[maybe_unused]] const Usage& reference,
+                         [[maybe_unused]] double slack) {
+#ifndef CHECK_NAMES_TSAN
+    INFO(usage.seconds << " s against " << reference.seconds << " s");
+    CHECK(usage.seconds <= reference.seconds * slack + kTimeNoise);
+#endif
+}
+
+void CheckBudget([[maybe_unused]] const std::string& name, [[maybe_unused]] const Usage& usage) {
+#ifndef CHECK_NAMES_TSAN
+    const char* path = std::getenv("CHECK_NAMES_SCALE_BASELINE");
+    if (!path) {
+        path = CHECK_NAMES_SCALE_BASELINE;
+    }
+    std::map<std::string, Usage> baseline;
+    {
+        std::ifstream in{path};
+        std::string run;
+        Usage recorded;
+        while (in >> run >> recorded.seconds >> recorded.peak_kb) {
+            baseline[run] = recorded;
+        }
+    }
+
+    INFO(name << ": " << usage.seconds << " s, " << usage.peak_kb << " kB");
+    if (std::getenv("CHECK_NAMES_SCALE_RECORD")) {
+        baseline[name] = usage;
+        std::ofstream out{path};
+        for (const auto& [run, recorded] : baseline) {
+            out << run << ' ' << recorded.seconds << ' ' << recorded.peak_kb << '\n';
+        }
+        WARN("Recorded the baseline in " << path);
+        return;
+    }
+    auto it = baseline.find(name);
+    if (it == baseline.end()) {
+        SKIP("No baseline for " << name << " in " << path
+                                << ", record one with CHECK_NAMES_SCALE_RECORD=1");
+    }
+    INFO("baseline: " << it->second.seconds << " s, " << it->second.peak_kb << " kB");
+    CHECK(usage.seconds <= it->second.seconds * kTimeSlack + kTimeNoise);
+    CHECK(usage.peak_kb <= it->second.peak_kb * kMemorySlack);
+#endif
+}
+
+size_t CountFindings(const std::unordered_map<std::string, Statistics>& result) {
+    size_t count = 0;
+    for (const auto& [file, stats] : result) {
+        count += stats.bad_names.size() + stats.mistakes.size();
+    }
+    return count;
+}
+
+} // namespace
+
+TEST_CASE("ScaleParallel") {
+    const auto& corpus = GetCorpus();
+
+    std::unordered_map<std::string, Statistics> serial, parallel;
+    auto serial_args = corpus.Args({"-j", "1"});
+    auto serial_usage = Measure([&] {
+        serial = CheckNames(serial_args.size(), serial_args.data());
+    });
+    auto parallel_args = corpus.Args({"-j", kJobs});
+    auto parallel_usage = Measure([&] {
+        parallel = CheckNames(parallel_args.size(), parallel_args.data());
+    });
+
+    // Every file is checked, every misspelled word is found, and workers do
+    // not change the results.
+    size_t units = 0, typos = 0;
+    for (const auto& [file, stats] : serial) {
+        CHECK_FALSE(stats.incomplete);
+        units += file.rfind("unit_", 0) == 0;
+        typos += stats.mistakes.size();
+    }
+    CHECK(units == kNumFiles);
+    CHECK(typos >= kNumFiles * kFunctionsPerFile / kTypoEvery);
+    CHECK(parallel == serial);
+    CheckRelativeBudget(parallel_usage, serial_usage, kParallelSlack);
+    CheckBudget("check_serial", serial_usage);
+    CheckBudget("check_parallel", parallel_usage);
+}
+
+TEST_CASE("ScaleSummary") {
+    const auto& corpus = GetCorpus();
+    auto check_args = corpus.Args({"-j", kJobs});
+    std::unordered_map<std::string, Statistics> result;
+    auto check_usage = Measure([&] {
+        result = CheckNames(check_args.size(), check_args.data());
+    });
+
+    NameSummary summary;
+    auto args = corpus.Args({"-j", kJobs, "-summary-top", "10"});
+    auto usage = Measure([&] {
+        summary = SummarizeNames(args.size(), args.data());
+    });
+
+    // Counts merged from the workers add up to the full results.
+    size_t count = 0;
+    for (const auto& bad : summary.bad_names) {
+        count += bad.count;
+    }
+    for (const auto& [directory, typos] : summary.typos) {
+        count += typos;
+    }
+    CHECK(count == CountFindings(result));
+    CHECK(summary.top_names.size() == 10);
+    CHECK_FALSE(summary.incomplete);
+    CheckRelativeBudget(usage, check_usage, kSummarySlack);
+    CheckBudget("summary_parallel", usage);
+}
+
+TEST_CASE("ScaleJumbo") {
+    const auto& corpus = GetCorpus();
+    auto check_args = corpus.Args({"-j", kJobs});
+    std::unordered_map<std::string, Statistics> result;
+    auto check_usage = Measure([&] {
+        result = CheckNames(check_args.size(), check_args.data());
+    });
+
+    std::unordered_map<std::string, Statistics> jumbo;
+    auto args = corpus.Args({"-j", kJobs, "-jumbo", "16"});
+    auto usage = Measure([&] {
+        jumbo = CheckNames(args.size(), args.data());
+    });
+
+    REQUIRE(jumbo.size() == result.size());
+    for (const auto& [file, stats] : result) {
+        INFO(file);
+        CHECK(SortedFindings(jumbo[file]) == SortedFindings(stats));
+    }
+    CheckRelativeBudget(usage, check_usage, kJumboSlack);
+    CheckBudget("jumbo_parallel", usage);
+}